@@ -0,0 +1,49 @@
+#ifndef BENCHMARK_COMMON_H
+#define BENCHMARK_COMMON_H
+
+#include <benchmark/benchmark.h>
+#include <nav_msgs/Path.h>
+#include <cmath>
+#include <cstdint>
+
+// Heap allocations since the start, counted by the operator new of benchmark_main.cpp
+uint64_t allocationCount();
+
+// Allocations per iteration and points per second, from the count taken before the benchmark loop
+inline void setCounters(benchmark::State &_state, uint64_t _allocations_before, int64_t _points_per_iteration) {
+    _state.counters["allocs"] = benchmark::Counter(allocationCount() - _allocations_before, benchmark::Counter::kAvgIterations);
+    _state.SetItemsProcessed(_state.iterations() * _points_per_iteration);
+}
+
+// Staircase of _count waypoints, every leg _spacing meters long along x or y, climbing slowly
+inline nav_msgs::Path makeWaypoints(int _count, double _spacing) {
+    nav_msgs::Path path;
+    path.header.frame_id = "map";
+    path.poses.resize(_count);
+    for (int i = 0; i < _count; i++) {
+        path.poses[i].pose.position.x = ((i + 1) / 2) * _spacing;
+        path.poses[i].pose.position.y = (i / 2) * _spacing;
+        path.poses[i].pose.position.z = 5.0 + 0.01 * i;
+        path.poses[i].pose.orientation.w = 1;
+    }
+    return path;
+}
+
+// Smooth path through _waypoints waypoints one meter apart, sampled with _points_per_meter poses per meter
+inline nav_msgs::Path makePath(int _waypoints, int _points_per_meter) {
+    nav_msgs::Path path;
+    path.header.frame_id = "map";
+    int size = _waypoints * _points_per_meter;
+    double radius = 20.0;
+    path.poses.resize(size);
+    for (int i = 0; i < size; i++) {
+        double s = double(i) / _points_per_meter;
+        path.poses[i].pose.position.x = radius * std::cos(s / radius);
+        path.poses[i].pose.position.y = radius * std::sin(s / radius);
+        path.poses[i].pose.position.z = 5.0 + 0.05 * s;
+        path.poses[i].pose.orientation.w = 1;
+    }
+    return path;
+}
+
+#endif /* BENCHMARK_COMMON_H */
@@ -0,0 +1,38 @@
+#include <upat_follower/follower.h>
+#include "benchmark_common.h"
+
+// Arguments: waypoints one meter apart and poses per meter of the followed path. Every iteration is a tick of the
+// control loop, the UAV moves along the path at the cruising speed with a lateral offset of 0.3 m
+
+void followerGetVelocity(benchmark::State &_state) {
+    int points_per_meter = _state.range(1);
+    nav_msgs::Path path = makePath(_state.range(0), points_per_meter);
+    double cruising_speed = 1.0, tick_period = 1.0 / 30.0;
+    int stride = std::max(1, int(std::lround(cruising_speed * tick_period * points_per_meter)));
+    upat_follower::Follower follower(1);
+    follower.loadPath(path, 1.2, cruising_speed);
+    geometry_msgs::PoseStamped pose;
+    pose.pose.orientation.w = 1;
+    double stamp = 1.0;
+    size_t index = 0;
+    uint64_t allocations_before = allocationCount();
+    for (auto _ : _state) {
+        if (index >= path.poses.size()) {
+            _state.PauseTiming();
+            follower.loadPath(path, 1.2, cruising_speed);
+            index = 0;
+            _state.ResumeTiming();
+        }
+        pose.header.stamp = ros::Time(stamp);
+        pose.pose.position = path.poses[index].pose.position;
+        pose.pose.position.z += 0.3;
+        follower.updatePose(pose);
+        benchmark::DoNotOptimize(follower.getVelocity());
+        index += stride;
+        stamp += tick_period;
+    }
+    setCounters(_state, allocations_before, 1);
+    _state.counters["path_points"] = path.poses.size();
+}
+
+BENCHMARK(followerGetVelocity)->ArgNames({"waypoints", "points_per_meter"})->RangeMultiplier(10)->Ranges({{10, 10000}, {10, 100}});
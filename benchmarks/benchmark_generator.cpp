@@ -0,0 +1,41 @@
+#include <upat_follower/generator.h>
+#include "benchmark_common.h"
+
+// Arguments: waypoints and meters between waypoints. The output grows with the length of the path, one pose every
+// 2 cm in interp1 mode and length poses per joint in the cubic spline modes, so these are quadratic in the waypoints
+
+void generatePath(benchmark::State &_state, int _generator_mode) {
+    upat_follower::Generator generator(2.0, 3.0, 1.0);
+    upat_follower::GeneratorWorkspace workspace;
+    nav_msgs::Path init_path = makeWaypoints(_state.range(0), _state.range(1));
+    size_t points = 0;
+    uint64_t allocations_before = allocationCount();
+    for (auto _ : _state) {
+        nav_msgs::Path path = generator.generatePath(init_path, _generator_mode, workspace).generated_path;
+        points = path.poses.size();
+        benchmark::DoNotOptimize(path);
+    }
+    setCounters(_state, allocations_before, points);
+    _state.counters["points"] = points;
+}
+
+void generateTrajectory(benchmark::State &_state) {
+    upat_follower::Generator generator(2.0, 3.0, 1.0);
+    upat_follower::GeneratorWorkspace workspace;
+    nav_msgs::Path init_path = makeWaypoints(_state.range(0), _state.range(1));
+    std::vector<double> times(init_path.poses.size() - 1, 1.0);
+    size_t points = 0;
+    uint64_t allocations_before = allocationCount();
+    for (auto _ : _state) {
+        nav_msgs::Path path = generator.generateTrajectory(init_path, times, workspace).generated_path;
+        points = path.poses.size();
+        benchmark::DoNotOptimize(path);
+    }
+    setCounters(_state, allocations_before, points);
+    _state.counters["points"] = points;
+}
+
+BENCHMARK_CAPTURE(generatePath, interp1, 0)->ArgNames({"waypoints", "spacing"})->RangeMultiplier(10)->Ranges({{10, 10000}, {1, 1}})->Args({100, 5})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(generatePath, cubic_spline_loyal, 1)->ArgNames({"waypoints", "spacing"})->RangeMultiplier(10)->Ranges({{10, 1000}, {1, 1}})->Args({100, 5})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(generatePath, cubic_spline, 2)->ArgNames({"waypoints", "spacing"})->RangeMultiplier(10)->Ranges({{10, 1000}, {1, 1}})->Args({100, 5})->Unit(benchmark::kMillisecond);
+BENCHMARK(generateTrajectory)->ArgNames({"waypoints", "spacing"})->RangeMultiplier(10)->Ranges({{10, 100}, {1, 1}})->Args({10, 5})->Unit(benchmark::kMillisecond);
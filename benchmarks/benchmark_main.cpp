@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+#include <ros/ros.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "benchmark_common.h"
+
+// Generator, follower, normal distance, mission loading and path codec hot paths, with time, allocations and points per
+// second:
+// $ rosrun upat_follower upat_follower_benchmarks --benchmark_filter=Follower
+// Without a roscore the generator falls back on its default velocities after the mavros parameter calls fail
+
+namespace {
+std::atomic<uint64_t> allocations(0);
+}
+
+uint64_t allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void *operator new(std::size_t _size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(_size ? _size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t _size) {
+    return operator new(_size);
+}
+
+void operator delete(void *_pointer) noexcept {
+    std::free(_pointer);
+}
+
+void operator delete[](void *_pointer) noexcept {
+    std::free(_pointer);
+}
+
+void operator delete(void *_pointer, std::size_t) noexcept {
+    std::free(_pointer);
+}
+
+void operator delete[](void *_pointer, std::size_t) noexcept {
+    std::free(_pointer);
+}
+
+int main(int _argc, char **_argv) {
+    ros::init(_argc, _argv, "upat_follower_benchmarks", ros::init_options::AnonymousName | ros::init_options::NoRosout | ros::init_options::NoSigintHandler);
+    ros::Time::init();
+    benchmark::Initialize(&_argc, _argv);
+    if (benchmark::ReportUnrecognizedArguments(_argc, _argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+
+    return 0;
+}
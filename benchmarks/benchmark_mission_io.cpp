@@ -0,0 +1,72 @@
+#include <upat_follower/mission_io.h>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include "benchmark_common.h"
+
+// Mission loader against the stringstream parser it replaced, on a logged path. Argument: poses of the file
+
+namespace {
+
+// Parser used by UALCommunication and tests_generator before mission_io
+nav_msgs::Path stringstreamCsvToPath(std::string file_name) {
+    nav_msgs::Path out_path;
+    std::fstream read_csv;
+    read_csv.open(file_name);
+    if (read_csv.is_open()) {
+        while (read_csv.good()) {
+            std::string x, y, z;
+            geometry_msgs::PoseStamped pose;
+            getline(read_csv, x, ',');
+            getline(read_csv, y, ',');
+            getline(read_csv, z, '\n');
+            std::stringstream sx(x);
+            std::stringstream sy(y);
+            std::stringstream sz(z);
+            sx >> pose.pose.position.x;
+            sy >> pose.pose.position.y;
+            sz >> pose.pose.position.z;
+            pose.pose.orientation.w = 1;
+            out_path.poses.push_back(pose);
+        }
+        out_path.poses.pop_back();
+    }
+
+    return out_path;
+}
+
+// Random positions with 5 decimals, as a logged path. Returns the size of the file in bytes
+size_t writeCsv(const std::string &_file_name, int _points) {
+    std::ofstream csv(_file_name);
+    csv << std::fixed << std::setprecision(5);
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> position(-100.0, 100.0);
+    for (int i = 0; i < _points; i++) {
+        csv << position(generator) << ", " << position(generator) << ", " << position(generator) << std::endl;
+    }
+    return csv.tellp();
+}
+
+}  // namespace
+
+void loadCsv(benchmark::State &_state, bool _mission_io) {
+    std::string file_name = "/tmp/upat_follower_benchmark_mission_io.csv";
+    size_t bytes = writeCsv(file_name, _state.range(0));
+    size_t points = 0;
+    uint64_t allocations_before = allocationCount();
+    for (auto _ : _state) {
+        nav_msgs::Path path = _mission_io ? upat_follower::csvToPath(file_name) : stringstreamCsvToPath(file_name);
+        points = path.poses.size();
+        benchmark::DoNotOptimize(path);
+    }
+    std::remove(file_name.c_str());
+    if (points != _state.range(0)) _state.SkipWithError("Wrong number of poses loaded");
+    setCounters(_state, allocations_before, points);
+    _state.SetBytesProcessed(_state.iterations() * bytes);
+}
+
+BENCHMARK_CAPTURE(loadCsv, stringstream, false)->ArgNames({"poses"})->RangeMultiplier(100)->Range(1e4, 1e6)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(loadCsv, mission_io, true)->ArgNames({"poses"})->RangeMultiplier(100)->Range(1e4, 1e6)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,27 @@
+#include <upat_follower/normal_distance.h>
+#include "benchmark_common.h"
+
+// Normal distance of Visualization, once per pose update. Arguments: waypoints one meter apart and poses per meter of
+// the path, the UAV moves along it 0.5 m away at 1 m/s with 30 Hz updates
+
+void normalDistance(benchmark::State &_state) {
+    int points_per_meter = _state.range(1);
+    nav_msgs::Path path = makePath(_state.range(0), points_per_meter);
+    int stride = std::max(1, int(std::lround(points_per_meter / 30.0)));
+    upat_follower::NormalDistance normal_distance;
+    size_t index = 0;
+    uint64_t allocations_before = allocationCount();
+    for (auto _ : _state) {
+        if (index >= path.poses.size()) {
+            normal_distance.reset();
+            index = 0;
+        }
+        const geometry_msgs::Point &position = path.poses[index].pose.position;
+        benchmark::DoNotOptimize(normal_distance.calculate(Eigen::Vector3f(position.x, position.y, position.z + 0.5), path));
+        index += stride;
+    }
+    setCounters(_state, allocations_before, 1);
+    _state.counters["path_points"] = path.poses.size();
+}
+
+BENCHMARK(normalDistance)->ArgNames({"waypoints", "points_per_meter"})->RangeMultiplier(10)->Ranges({{10, 10000}, {10, 100}});
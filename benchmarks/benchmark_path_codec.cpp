@@ -0,0 +1,83 @@
+#include <upat_follower/path_codec.h>
+#include <algorithm>
+#include <cmath>
+#include "benchmark_common.h"
+
+// Encode and decode throughput of the path codec on a smooth path, as bytes of raw float64 positions per second.
+// Arguments: poses and resolution in millimetres. The compression ratio and max error are reported as counters
+
+namespace {
+
+// Spiral climb sampled every centimetre, as the generator output
+nav_msgs::Path spiralPath(int _points) {
+    nav_msgs::Path path;
+    path.poses.resize(_points);
+    for (int i = 0; i < _points; i++) {
+        double t = i * 0.0005;
+        path.poses[i].pose.position.x = 20.0 * std::cos(t);
+        path.poses[i].pose.position.y = 20.0 * std::sin(t);
+        path.poses[i].pose.position.z = 5.0 + 0.5 * t;
+        path.poses[i].pose.orientation.w = 1;
+    }
+    return path;
+}
+
+double rawBytes(const nav_msgs::Path &_path) {
+    return _path.poses.size() * 3.0 * sizeof(double);
+}
+
+}  // namespace
+
+void encodePath(benchmark::State &_state) {
+    nav_msgs::Path path = spiralPath(_state.range(0));
+    double resolution = _state.range(1) * 0.001;
+    std::vector<uint8_t> data;
+    for (auto _ : _state) {
+        data = upat_follower::encodePath(path, resolution);
+        benchmark::DoNotOptimize(data.data());
+    }
+    _state.SetBytesProcessed(_state.iterations() * rawBytes(path));
+    _state.counters["ratio"] = rawBytes(path) / data.size();
+}
+
+void decodePath(benchmark::State &_state) {
+    nav_msgs::Path path = spiralPath(_state.range(0));
+    double resolution = _state.range(1) * 0.001;
+    std::vector<uint8_t> data = upat_follower::encodePath(path, resolution);
+    nav_msgs::Path decoded;
+    bool ok = true;
+    for (auto _ : _state) {
+        ok = upat_follower::decodePath(data.data(), data.size(), decoded) && ok;
+        benchmark::DoNotOptimize(decoded);
+    }
+    double max_error = 0;
+    for (int i = 0; i < path.poses.size() && ok; i++) {
+        max_error = std::max(max_error, std::fabs(decoded.poses[i].pose.position.x - path.poses[i].pose.position.x));
+        max_error = std::max(max_error, std::fabs(decoded.poses[i].pose.position.y - path.poses[i].pose.position.y));
+        max_error = std::max(max_error, std::fabs(decoded.poses[i].pose.position.z - path.poses[i].pose.position.z));
+    }
+    if (!ok || max_error > resolution / 2 * (1 + 1e-6)) _state.SkipWithError("Decoded path differs from the encoded one");
+    _state.SetBytesProcessed(_state.iterations() * rawBytes(path));
+    _state.counters["max_error"] = max_error;
+}
+
+// Columns alone, without filling the poses, as the cache and the log use it
+void decodeColumns(benchmark::State &_state) {
+    nav_msgs::Path path = spiralPath(_state.range(0));
+    double resolution = _state.range(1) * 0.001;
+    std::vector<uint8_t> data = upat_follower::encodePath(path, resolution);
+    std::vector<double> column(3 * path.poses.size());
+    bool ok = true;
+    for (auto _ : _state) {
+        size_t pos = 24;  // Header of encodePath
+        for (int axis = 0; axis < 3; axis++) pos += upat_follower::decodeColumn(data.data() + pos, data.size() - pos, path.poses.size(), resolution, &column[axis * path.poses.size()]);
+        ok = pos == data.size() && ok;
+        benchmark::DoNotOptimize(column.data());
+    }
+    if (!ok) _state.SkipWithError("Columns do not fill the encoded data");
+    _state.SetBytesProcessed(_state.iterations() * rawBytes(path));
+}
+
+BENCHMARK(encodePath)->ArgNames({"poses", "resolution_mm"})->RangeMultiplier(100)->Ranges({{1e4, 1e6}, {1, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(decodePath)->ArgNames({"poses", "resolution_mm"})->RangeMultiplier(100)->Ranges({{1e4, 1e6}, {1, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(decodeColumns)->ArgNames({"poses", "resolution_mm"})->RangeMultiplier(100)->Ranges({{1e4, 1e6}, {1, 1}})->Unit(benchmark::kMillisecond);
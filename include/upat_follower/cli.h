@@ -0,0 +1,54 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef CLI_H
+#define CLI_H
+
+#include <sys/stat.h>
+#include <map>
+#include <string>
+
+namespace upat_follower {
+
+// Command line of the offline tools, pairs of --key value. Keys already in _args keep their value as the default
+// unless they are given.
+inline void parseArgs(int _argc, char **_argv, std::map<std::string, std::string> &_args) {
+    for (int i = 1; i + 1 < _argc; i += 2) {
+        std::string key = _argv[i];
+        if (key.compare(0, 2, "--") == 0) _args[key.substr(2)] = _argv[i + 1];
+    }
+}
+
+inline bool isFile(const std::string &_file_name) {
+    struct stat file_stat;
+    return stat(_file_name.c_str(), &file_stat) == 0 && S_ISREG(file_stat.st_mode);
+}
+
+inline bool startsWith(const std::string &_text, const std::string &_start) {
+    return _text.compare(0, _start.size(), _start) == 0;
+}
+
+inline bool endsWith(const std::string &_text, const std::string &_end) {
+    return _text.size() >= _end.size() && _text.compare(_text.size() - _end.size(), _end.size(), _end) == 0;
+}
+
+}  // namespace upat_follower
+
+#endif /* CLI_H */
\ No newline at end of file
@@ -0,0 +1,36 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef FLAT_PATH_H
+#define FLAT_PATH_H
+
+#include <nav_msgs/Path.h>
+#include <upat_follower/FlatPath.h>
+
+namespace upat_follower {
+
+// Conversions between nav_msgs::Path and FlatPath, the compact path of the *Flat services: 24 bytes per pose instead
+// of a header, a frame string and a quaternion per pose
+upat_follower::FlatPath toFlatPath(const nav_msgs::Path &_path);
+nav_msgs::Path toPath(const upat_follower::FlatPath &_flat_path);
+
+}  // namespace upat_follower
+
+#endif /* FLAT_PATH_H */
\ No newline at end of file
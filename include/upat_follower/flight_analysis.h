@@ -0,0 +1,50 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef FLIGHT_ANALYSIS_H
+#define FLIGHT_ANALYSIS_H
+
+#include <nav_msgs/Path.h>
+#include <Eigen/Eigen>
+#include <string>
+#include <vector>
+
+namespace upat_follower {
+
+// Tracking metrics of a recorded flight against its reference path, distances in meters
+struct FlightMetrics {
+    std::string name;
+    int samples = 0;
+    bool completed = false;      // Last pose within the goal tolerance of the end of the reference
+    double completion_time = -1; // Last time of the normal_dist log, negative without log
+    double mean_normal_distance = 0, rms_normal_distance = 0, max_normal_distance = 0, p95_normal_distance = 0;
+    double mean_cross_track = 0, rms_cross_track = 0, max_cross_track = 0, p95_cross_track = 0;
+};
+
+// Distance from the point to the polyline of the path, on the segments next to the _closest pose
+double crossTrackError(const Eigen::Vector3f &_point, const nav_msgs::Path &_path, int _closest);
+
+// Normal distance (to the closest pose, as Visualization) and cross-track error of every pose of the flight. _times
+// are the times of the normal_dist log of the flight, may be empty.
+FlightMetrics analyseFlight(const nav_msgs::Path &_flight, const nav_msgs::Path &_reference, const std::vector<double> &_times, double _goal_tolerance = 1.0);
+
+}  // namespace upat_follower
+
+#endif /* FLIGHT_ANALYSIS_H */
\ No newline at end of file
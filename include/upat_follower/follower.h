@@ -23,10 +23,17 @@
 #include <ros/ros.h>
 #include <uav_abstraction_layer/ual.h>
 #include <upat_follower/PreparePath.h>
+#include <upat_follower/PreparePathFlat.h>
 #include <upat_follower/PrepareTrajectory.h>
+#include <upat_follower/PrepareTrajectoryFlat.h>
+#include <upat_follower/PreparedPath.h>
+#include <upat_follower/LoadSharedPath.h>
 #include <upat_follower/UpdatePath.h>
 #include <upat_follower/UpdateTrajectory.h>
 #include <upat_follower/generator.h>
+#include <upat_follower/instrumentation.h>
+#include <upat_follower/path_cache.h>
+#include <upat_follower/trace.h>
 #include <Eigen/Eigen>
 #include "geometry_msgs/PointStamped.h"
 #include "geometry_msgs/PoseStamped.h"
@@ -38,7 +45,8 @@ namespace upat_follower {
 class Follower {
    public:
     Follower();
-    Follower(int _uav_id, bool _debug = false);
+    Follower(ros::NodeHandle _nh, ros::NodeHandle _pnh);
+    Follower(int _uav_id, bool _debug = false, bool _diagnostics = false);
     ~Follower();
 
     void pubMsgs();
@@ -49,31 +57,48 @@ class Follower {
     void updateTrajectory(nav_msgs::Path _new_target_path, nav_msgs::Path _new_target_vel_path);
     nav_msgs::Path prepareTrajectory(nav_msgs::Path _init_path, std::vector<double> _times);
     nav_msgs::Path preparePath(nav_msgs::Path _init_path, int _generator_mode = 0, double _look_ahead = 1.2, double _cruising_speed = 1.0);
+    void loadPath(nav_msgs::Path _target_path, double _look_ahead = 1.2, double _cruising_speed = 1.0);
+    void loadTrajectory(nav_msgs::Path _target_path, std::vector<double> _speed_percentages, double _max_velocity);
+    bool loadPathCache(const PathCache &_cache, double _look_ahead = 1.2, double _cruising_speed = 1.0);
+    PathCache getPathCache();
+    std::pair<int, int> getSearchWindow();
+    int getPosLookAhead(int _pos_on_path, bool _use_table = true);
+    std::vector<double> timesToMaxVelPercentage(nav_msgs::Path _init_path, std::vector<double> _times);
+    void setMaxVelocities(double _vxy, double _vz_up, double _vz_dn);
 
    private:
     // Callbacks
     void ualPoseCallback(const geometry_msgs::PoseStamped::ConstPtr &_ual_pose);
+    void preparedPathCallback(const upat_follower::PreparedPath::ConstPtr &_prepared_path);
     bool preparePathCb(upat_follower::PreparePath::Request &_req_path, upat_follower::PreparePath::Response &_res_path);
     bool prepareTrajectoryCb(upat_follower::PrepareTrajectory::Request &_req_trajectory, upat_follower::PrepareTrajectory::Response &_res_trajectory);
+    bool preparePathFlatCb(upat_follower::PreparePathFlat::Request &_req_path, upat_follower::PreparePathFlat::Response &_res_path);
+    bool prepareTrajectoryFlatCb(upat_follower::PrepareTrajectoryFlat::Request &_req_trajectory, upat_follower::PrepareTrajectoryFlat::Response &_res_trajectory);
+    bool loadSharedPathCb(upat_follower::LoadSharedPath::Request &_req_path, upat_follower::LoadSharedPath::Response &_res_path);
     bool updatePathCb(upat_follower::UpdatePath::Request &_req_path, upat_follower::UpdatePath::Response &_res_path);
     bool updateTrajectoryCb(upat_follower::UpdateTrajectory::Request &_req_trajectory, upat_follower::UpdateTrajectory::Response &_res_trajectory);
     // Methods
     void capMaxVelocities();
+    void resetSearch();
+    void buildLookAheadTable();
     double changeLookAhead(int _pos_on_path);
     int calculatePosLookAhead(int _pos_on_path);
     int calculateDistanceOnPath(int _prev_normal_pos_on_path, double _meters);
-    int calculatePosOnPath(Eigen::Vector3f _current_point, double _search_range, int _prev_normal_pos_on_path, nav_msgs::Path _path_search);
+    double calculateSearchRange(Eigen::Vector3f _current_point);
+    bool isOnSearchEdge(int _pos_on_path);
+    int searchPosOnPath(Eigen::Vector3f _current_point, double &_search_range, int _prev_normal_pos_on_path);
+    int calculatePosOnPath(Eigen::Vector3f _current_point, double _search_range, int _prev_normal_pos_on_path, const nav_msgs::Path &_path_search);
     void prepareDebug(double _search_range, int _normal_pos_on_path, int _pos_look_ahead, int _prev_normal);
+    void pubDiagnostics();
     geometry_msgs::TwistStamped calculateVelocity(Eigen::Vector3f _current_point, int _pos_look_ahead, int _pos_on_path = 0);
-    std::vector<double> timesToMaxVelPercentage(nav_msgs::Path _init_path, std::vector<double> _times);
     // Node handlers
     ros::NodeHandle nh_, pnh_;
     // Subscribers
-    ros::Subscriber sub_pose_;
+    ros::Subscriber sub_pose_, sub_prepared_path_;
     // Publishers
-    ros::Publisher pub_output_velocity_, pub_point_look_ahead_, pub_point_normal_, pub_point_search_normal_begin_, pub_point_search_normal_end_;
+    ros::Publisher pub_output_velocity_, pub_point_look_ahead_, pub_point_normal_, pub_point_search_normal_begin_, pub_point_search_normal_end_, pub_diagnostics_;
     // Services
-    ros::ServiceServer server_prepare_path_, server_prepare_trajectory_;
+    ros::ServiceServer server_prepare_path_, server_prepare_trajectory_, server_prepare_path_flat_, server_prepare_trajectory_flat_, server_load_shared_path_;
     // Variables
     double vxy_ = 2.0;
     double vz_up_ = 3.0;
@@ -82,19 +107,38 @@ class Follower {
     std::vector<double> mpc_xy_vel_max_ = {0.0, 20.0};   // Default PX4 parameter limits
     std::vector<double> mpc_z_vel_max_up_ = {0.5, 8.0};  // Default PX4 parameter limits
     std::vector<double> mpc_z_vel_max_dn_ = {0.5, 4.0};  // Default PX4 parameter limits
-    int follower_mode_;
+    int follower_mode_ = 0;
+    int generator_mode_ = 0;
     int prev_normal_pos_on_path_ = 0;
     int prev_normal_vel_on_path_ = 0;
+    int start_search_pos_on_path_ = 0;
+    int end_search_pos_on_path_ = 0;
+    int prev_pos_look_ahead_ = -1;
+    // Search window
+    double search_tick_period_ = 1.0 / 30.0;
+    double search_safety_factor_ = 2.0;
+    double search_margin_ = 0.5;
+    int search_max_expansions_ = 8;
+    double measured_speed_ = 0.0;
+    bool has_prev_point_ = false;
+    Eigen::Vector3f prev_point_;
+    ros::Time prev_stamp_;
     bool flag_run_ = false;
     geometry_msgs::PoseStamped ual_pose_;
     nav_msgs::Path target_path_, target_vel_path_;
     double look_ahead_, cruising_speed_, max_vel_;
     std::vector<double> generated_times_;
+    std::vector<int> look_ahead_table_;
+    GeneratorWorkspace generator_workspace_;  // Buffers reused by every path and trajectory prepared
     // Params
     int uav_id_;
     bool debug_;
+    bool diagnostics_ = false;
+    double diagnostics_rate_ = 1.0;
     // Debug
     geometry_msgs::PointStamped point_look_ahead_, point_normal_, point_search_normal_begin_, point_search_normal_end_;
+    // Diagnostics
+    Instrumentation instrumentation_;
 };
 
 }  // namespace upat_follower
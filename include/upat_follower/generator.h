@@ -19,65 +19,115 @@
 #ifndef GENERATOR_H
 #define GENERATOR_H
 
+#include <actionlib/server/simple_action_server.h>
 #include <mavros_msgs/ParamGet.h>
 #include <ros/ros.h>
 #include <upat_follower/GeneratePath.h>
+#include <upat_follower/GeneratePathFlat.h>
+#include <upat_follower/GeneratePathShared.h>
 #include <upat_follower/GenerateTrajectory.h>
+#include <upat_follower/GenerateTrajectoryAction.h>
+#include <upat_follower/GenerateTrajectoryFlat.h>
+#include <upat_follower/GenerateTrajectoryShared.h>
+#include <upat_follower/flat_path.h>
+#include <upat_follower/path_cache.h>
+#include <upat_follower/trace.h>
 #include <Eigen/Eigen>
 #include "ecl/geometry.hpp"
 #include "geometry_msgs/PoseStamped.h"
 #include "nav_msgs/Path.h"
 #include "std_msgs/Float32.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 
 namespace upat_follower {
 
+// Output of a generation. Paths are empty when the generation failed or was cancelled
+struct GeneratorResult {
+    nav_msgs::Path generated_path;
+    nav_msgs::Path generated_path_vel_percentage;  // Trajectories only
+    std::vector<double> generated_times;           // Trajectories only, percentage of max_velocity per pose
+    double max_velocity = 0.0;                     // Trajectories only
+};
+
+// Scratch buffers of a generation, owned by the caller and reused across calls so their capacity is allocated once.
+// A workspace must not be used by two calls at the same time
+struct GeneratorWorkspace {
+    std::vector<double> list_x, list_y, list_z;           // Waypoints, the last one repeated
+    std::vector<double> aux_axis, new_aux_axis;           // Interpolation abscissae
+    std::vector<double> interp1_x, interp1_y, interp1_z;  // Linear interpolation
+    std::vector<double> spline_x, spline_y, spline_z;     // Sampled splines
+};
+
+// Generation methods are const and keep no state between calls, so an instance can be shared between threads as long
+// as every thread passes its own workspace. Overloads without one use a workspace of the calling thread
 class Generator {
    public:
     Generator();
+    Generator(ros::NodeHandle _nh, ros::NodeHandle _pnh);
     Generator(double _vxy, double _vz_up, double _vz_dn, bool _debug = false);
     ~Generator();
 
-    double max_velocity_;
-    nav_msgs::Path out_path_;
-    nav_msgs::Path generated_path_vel_percentage_;
-    std::vector<double> generated_times_;
-    nav_msgs::Path generateTrajectory(nav_msgs::Path _init_path, std::vector<double> _times);
-    nav_msgs::Path generatePath(nav_msgs::Path _init_path, int _generator_mode = 0);
+    // Called once per spline fitting iteration with the current joints, the velocity bound and the spline max velocity,
+    // false cancels it
+    typedef std::function<bool(int _iteration, int _num_joints, double _max_vel, double _spline_max_vel)> ProgressCallback;
+    GeneratorResult generatePath(const nav_msgs::Path &_init_path, int _generator_mode, GeneratorWorkspace &_workspace) const;
+    GeneratorResult generateTrajectory(const nav_msgs::Path &_init_path, const std::vector<double> &_times, GeneratorWorkspace &_workspace, const ProgressCallback &_progress = ProgressCallback()) const;
+    nav_msgs::Path generatePath(const nav_msgs::Path &_init_path, int _generator_mode = 0) const;
+    GeneratorResult generateTrajectory(const nav_msgs::Path &_init_path, const std::vector<double> &_times, const ProgressCallback &_progress = ProgressCallback()) const;
+    // Default velocities, used until they are read from mavros
+    void setMaxVelocities(double _vxy, double _vz_up, double _vz_dn);
 
    private:
+    enum mode_t { mode_interp1_,
+                  mode_cubic_spline_loyal_,
+                  mode_cubic_spline_,
+                  mode_trajectory_,
+                  mode_idle_ };
     // Callbacks
     bool generatePathCb(upat_follower::GeneratePath::Request &_req_path, upat_follower::GeneratePath::Response &_res_path);
     bool generateTrajectoryCb(upat_follower::GenerateTrajectory::Request &_req_trajectory, upat_follower::GenerateTrajectory::Response &_res_trajectory);
+    bool generatePathFlatCb(upat_follower::GeneratePathFlat::Request &_req_path, upat_follower::GeneratePathFlat::Response &_res_path);
+    bool generateTrajectoryFlatCb(upat_follower::GenerateTrajectoryFlat::Request &_req_trajectory, upat_follower::GenerateTrajectoryFlat::Response &_res_trajectory);
+    bool generatePathSharedCb(upat_follower::GeneratePathShared::Request &_req_path, upat_follower::GeneratePathShared::Response &_res_path);
+    bool generateTrajectorySharedCb(upat_follower::GenerateTrajectoryShared::Request &_req_trajectory, upat_follower::GenerateTrajectoryShared::Response &_res_trajectory);
+    void generateTrajectoryActionCb(const upat_follower::GenerateTrajectoryGoalConstPtr &_goal);
     // Methods
-    double checkSmallestMaxVel();
-    double updateParam(const std::string &_param_id);
-    int nearestNeighbourIndex(std::vector<double> &_x, double &_value);
-    std::vector<double> interpWaypointList(std::vector<double> _list_pose_axis, int _amount_of_points);
-    std::vector<double> linealInterp1(std::vector<double> &_x, std::vector<double> &_y, std::vector<double> &_x_new);
-    nav_msgs::Path constructPath(std::vector<double> _wps_x, std::vector<double> _wps_y, std::vector<double> _wps_z);
-    nav_msgs::Path pathManagement(std::vector<double> _list_pose_x, std::vector<double> _list_pose_y, std::vector<double> _list_pose_z);
-    nav_msgs::Path createPathCubicSpline(std::vector<double> _list_x, std::vector<double> _list_y, std::vector<double> _list_z, int _path_size);
-    nav_msgs::Path createPathInterp1(std::vector<double> _list_x, std::vector<double> _list_y, std::vector<double> _list_z, int _path_size, int _new_path_size);
-    nav_msgs::Path createTrajectory(std::vector<double> _list_x, std::vector<double> _list_y, std::vector<double> _list_z, int _path_size, std::vector<double> _times);
+    double checkSmallestMaxVel() const;
+    bool sharePath(PathCache &_cache, std::string &_handle);
+    double updateParam(const std::string &_param_id) const;
+    int nearestNeighbourIndex(const std::vector<double> &_x, double _value) const;
+    void interpWaypointList(const std::vector<double> &_list_pose_axis, int _amount_of_points, std::vector<double> &_interp1_list, GeneratorWorkspace &_workspace) const;
+    void linealInterp1(const std::vector<double> &_x, const std::vector<double> &_y, const std::vector<double> &_x_new, std::vector<double> &_y_new) const;
+    void constructPath(const std::vector<double> &_wps_x, const std::vector<double> &_wps_y, const std::vector<double> &_wps_z, nav_msgs::Path &_path) const;
+    void loadWaypoints(const nav_msgs::Path &_init_path, GeneratorWorkspace &_workspace) const;
+    nav_msgs::Path pathManagement(mode_t _mode, int _interp1_final_size, GeneratorWorkspace &_workspace) const;
+    nav_msgs::Path createPathCubicSpline(mode_t _mode, GeneratorWorkspace &_workspace) const;
+    nav_msgs::Path createPathInterp1(int _new_path_size, GeneratorWorkspace &_workspace) const;
+    nav_msgs::Path createTrajectory(int _size_vec_percentage, double &_smallest_max_vel, const ProgressCallback &_progress, GeneratorWorkspace &_workspace) const;
     // Node handlers
     ros::NodeHandle nh_;
     ros::NodeHandle pnh_;
     // Services
-    ros::ServiceClient get_param_client_;
-    ros::ServiceServer server_generate_path_, server_generate_trajectory_;
+    mutable ros::ServiceClient get_param_client_;
+    ros::ServiceServer server_generate_path_, server_generate_trajectory_, server_generate_path_flat_, server_generate_trajectory_flat_;
+    ros::ServiceServer server_generate_path_shared_, server_generate_trajectory_shared_;
+    // Actions
+    std::unique_ptr<actionlib::SimpleActionServer<upat_follower::GenerateTrajectoryAction> > generate_trajectory_action_;
     // Variables
-    double smallest_max_vel_ = 1.0;
-    int size_vec_percentage_ = 0;
-    int interp1_final_size_ = 10000;
-    enum mode_t { mode_interp1_,
-                  mode_cubic_spline_loyal_,
-                  mode_cubic_spline_,
-                  mode_trajectory_,
-                  mode_idle_ };
-    mode_t mode_ = mode_idle_;
+    std::deque<std::string> shared_paths_;
+    uint64_t shared_path_count_ = 0;
+    std::mutex shared_paths_mutex_;
+    mutable std::mutex params_mutex_;
+    std::atomic<bool> stop_generation_{false};
     // Params
-    bool debug_;
-    std::map<std::string, double> mavros_params_;
+    bool debug_ = false;
+    int shared_path_segments_ = 4;
+    double action_feedback_rate_ = 10.0;
+    mutable std::map<std::string, double> mavros_params_;
 };
 
 }  // namespace upat_follower
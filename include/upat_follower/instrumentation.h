@@ -0,0 +1,84 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <upat_follower/FollowerDiagnostics.h>
+#include <chrono>
+#include <vector>
+
+namespace upat_follower {
+
+class LatencyHistogram {
+   public:
+    LatencyHistogram();
+    ~LatencyHistogram();
+
+    static const std::vector<double> &bounds();
+    void add(double _us);
+    void reset();
+    double mean() const;
+    double max() const;
+    std::vector<uint32_t> counts_;
+
+   private:
+    // Variables
+    uint32_t samples_ = 0;
+    double sum_us_ = 0.0;
+    double max_us_ = 0.0;
+};
+
+class Instrumentation {
+   public:
+    Instrumentation();
+    ~Instrumentation();
+
+    enum stage_t { stage_search_,
+                   stage_look_ahead_,
+                   stage_velocity_,
+                   stage_total_,
+                   stage_count_ };
+    void startTick();
+    void endStage(stage_t _stage);
+    void endTick();
+    void addSearchWindow(int _start_search, int _end_search, int _pos_found, int _path_size);
+    void addLookAhead(double _displacement, double _look_ahead);
+    bool isDue(double _period);
+    void fillMsg(upat_follower::FollowerDiagnostics &_msg);
+    void reset();
+
+   private:
+    typedef std::chrono::steady_clock clock_t;
+    // Variables
+    LatencyHistogram histograms_[stage_count_];
+    clock_t::time_point tick_begin_, stage_begin_, last_report_;
+    uint32_t ticks_ = 0;
+    uint32_t window_edge_hits_ = 0;
+    uint32_t look_ahead_jumps_ = 0;
+    uint32_t search_window_min_ = 0;
+    uint32_t search_window_max_ = 0;
+    uint64_t search_window_sum_ = 0;
+    uint32_t search_windows_ = 0;
+};
+
+}  // namespace upat_follower
+
+#endif /* INSTRUMENTATION_H */
@@ -0,0 +1,46 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef MISSION_IO_H
+#define MISSION_IO_H
+
+#include <nav_msgs/Path.h>
+#include <string>
+#include <vector>
+
+namespace upat_follower {
+
+// Read a numeric CSV file into _values, row after row. Fields are separated by commas, spaces or tabs. Empty lines,
+// '#' comments and header lines before the first row are skipped. Every row needs _columns fields at least (extra
+// fields are ignored). On error the line number is reported with ROS_ERROR and false is returned.
+bool readCsv(const std::string &_file_name, int _columns, std::vector<double> &_values);
+
+// Waypoints or logged positions, one x, y, z row per pose. Empty path if the file can not be read.
+nav_msgs::Path csvToPath(const std::string &_file_name, const std::string &_frame_id = "");
+
+// One value per row, as the times of a trajectory. Empty if the file can not be read.
+std::vector<double> csvToVector(const std::string &_file_name);
+
+// Write one "x, y, z" row per pose with _precision fixed decimals, formatted in memory and written at once
+bool pathToCsv(const std::string &_file_name, const nav_msgs::Path &_path, int _precision = 5);
+
+}  // namespace upat_follower
+
+#endif /* MISSION_IO_H */
\ No newline at end of file
@@ -0,0 +1,85 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef MISSION_LOG_H
+#define MISSION_LOG_H
+
+#include <upat_follower/spsc_queue.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace upat_follower {
+
+// Binary mission log: a MissionLogHeader followed by fixed size MissionLogRecord, in the order they were logged. The
+// header keeps the names of the CSV files that convertMissionLog writes, with the layout of the former CSV logs.
+struct MissionLogHeader {
+    char magic_[8];  // "UPATLOG"
+    uint32_t version_;
+    uint32_t record_size_;
+    char normal_dist_csv_[64];
+    char current_path_csv_[64];
+};
+
+struct MissionLogRecord {
+    enum record_t { normal_distance_ = 1, current_path_ = 2 };
+    uint32_t type_;
+    uint32_t reserved_;
+    // normal_distance_: time, distance to the generated path, distance to the init path (NaN if not computed)
+    // current_path_: x, y, z
+    double values_[3];
+};
+
+// Records are queued by the caller thread and written by a writer thread, so logging never blocks the caller. The
+// file is flushed every _flush_period seconds, a crash loses that much data at most. Records are dropped and counted
+// when the queue is full. Only one thread may log at a time.
+class MissionLog {
+   public:
+    explicit MissionLog(size_t _queue_capacity = 65536);
+    ~MissionLog();
+
+    bool open(const std::string &_file_name, const std::string &_normal_dist_csv, const std::string &_current_path_csv, double _flush_period = 0.5);
+    void close();
+    bool isOpen() const { return file_ != NULL; }
+    bool logNormalDistance(double _time, double _generated_path, double _init_path);
+    bool logCurrentPath(double _x, double _y, double _z);
+    uint64_t dropped() const { return dropped_.load(); }
+
+   private:
+    bool log(uint32_t _type, double _a, double _b, double _c);
+    void writerLoop();
+
+    SpscQueue<MissionLogRecord> queue_;
+    FILE *file_ = NULL;
+    double flush_period_ = 0.5;
+    std::thread writer_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> dropped_;
+};
+
+// Write the CSV files of a mission log in _folder (the folder of the log by default). A record cut by a crash at the
+// end of the log is ignored.
+bool convertMissionLog(const std::string &_file_name, const std::string &_folder = "");
+
+}  // namespace upat_follower
+
+#endif /* MISSION_LOG_H */
\ No newline at end of file
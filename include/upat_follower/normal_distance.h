@@ -0,0 +1,49 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef NORMAL_DISTANCE_H
+#define NORMAL_DISTANCE_H
+
+#include <Eigen/Eigen>
+#include "nav_msgs/Path.h"
+
+namespace upat_follower {
+
+// Distance from a point to the closest point of a path, searching around the closest point of the previous call
+class NormalDistance {
+   public:
+    NormalDistance(double _search_range = 2.0);
+    ~NormalDistance();
+
+    double calculate(Eigen::Vector3f _current_point, const nav_msgs::Path &_path_search);
+    void reset();
+    int normal_pos_on_path_ = 0;
+    double normal_distance_ = 0.0;
+
+   private:
+    // Methods
+    int calculateDistanceOnPath(int _prev_normal_pos_on_path, double _meters, const nav_msgs::Path &_path_search);
+    // Variables
+    double search_range_;
+};
+
+}  // namespace upat_follower
+
+#endif /* NORMAL_DISTANCE_H */
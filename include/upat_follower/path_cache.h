@@ -0,0 +1,101 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <nav_msgs/Path.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace upat_follower {
+
+// Binary file of a generated path. Native endianness, every field 8 bytes aligned:
+// PathCacheHeader, then size_ float64 values of x, y and z, then arc length and speed (percentage of max_velocity_)
+// if their flags are set.
+struct PathCacheHeader {
+    enum flag_t { flag_arc_length_ = 1,
+                  flag_speed_ = 2 };
+    char magic_[8];
+    uint32_t version_;
+    uint32_t flags_;
+    uint64_t size_;
+    int32_t generator_mode_;  // Generator modes, or trajectory_mode_ for trajectories
+    uint32_t reserved_;
+    double vxy_, vz_up_, vz_dn_, max_velocity_;
+    uint64_t hash_;  // Mission the path was generated from, see hashMission
+    char frame_id_[96];
+};
+
+struct PathCache {
+    static const int trajectory_mode_ = 3;
+    int generator_mode_ = 0;
+    double vxy_ = 0.0, vz_up_ = 0.0, vz_dn_ = 0.0, max_velocity_ = 0.0;
+    uint64_t hash_ = 0;
+    nav_msgs::Path path_;
+    std::vector<double> arc_length_, speed_;
+};
+
+// Read only view of a path cache file or shared memory segment, columns point straight into the mapped memory
+class MappedPathCache {
+   public:
+    MappedPathCache();
+    ~MappedPathCache();
+
+    bool open(const std::string &_file_name);
+    bool openShared(const std::string &_name);
+    void close();
+    const PathCacheHeader &header() const { return *header_; }
+    const double *x() const { return column(0); }
+    const double *y() const { return column(1); }
+    const double *z() const { return column(2); }
+    const double *arcLength() const { return header_->flags_ & PathCacheHeader::flag_arc_length_ ? column(3) : nullptr; }
+    const double *speed() const;
+
+   private:
+    MappedPathCache(const MappedPathCache &);
+    MappedPathCache &operator=(const MappedPathCache &);
+    bool map(int _fd, const std::string &_file_name);
+    const double *column(int _index) const;
+    // Variables
+    void *data_ = nullptr;
+    size_t data_size_ = 0;
+    const PathCacheHeader *header_ = nullptr;
+};
+
+// FNV-1a of the waypoints, times and generator mode of a mission
+uint64_t hashMission(const nav_msgs::Path &_init_path, const std::vector<double> &_times, int _generator_mode);
+
+// Arc length is computed from the path if _cache has none
+bool savePathCache(const std::string &_file_name, const PathCache &_cache);
+bool loadPathCache(const std::string &_file_name, PathCache &_cache);
+
+// Same layout in a named POSIX shared memory segment (_name as "/upat_follower_..."). Every write creates a new
+// segment and fails if _name exists, so a reader that mapped a removed one keeps a consistent copy until it closes it.
+// A segment being written is rejected as not a path cache, open a handle only once the write returned, after the
+// generate_*_shared response.
+bool writeSharedPathCache(const std::string &_name, const PathCache &_cache);
+bool loadSharedPathCache(const std::string &_name, PathCache &_cache);
+void removeSharedPathCache(const std::string &_name);
+
+}  // namespace upat_follower
+
+#endif /* PATH_CACHE_H */
\ No newline at end of file
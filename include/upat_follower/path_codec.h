@@ -0,0 +1,51 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef PATH_CODEC_H
+#define PATH_CODEC_H
+
+#include <nav_msgs/Path.h>
+#include <upat_follower/CompressedPath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace upat_follower {
+
+// Codec for densely sampled smooth paths. Every column (x, y or z) is quantised to _resolution (the error is half of
+// it at most), then stored as its first value, its first delta and the second order deltas, which are small on smooth
+// paths. These are zigzag encoded and bit packed in blocks of 128 values of the bit width of the largest one.
+
+// Append the encoded column to _data
+void encodeColumn(const double *_values, size_t _size, double _resolution, std::vector<uint8_t> &_data);
+// Decode _size values starting at _data, return the number of bytes read or zero if the data is truncated
+size_t decodeColumn(const uint8_t *_data, size_t _data_size, size_t _size, double _resolution, double *_values);
+
+// Size, resolution and the x, y and z columns, for files and caches
+std::vector<uint8_t> encodePath(const nav_msgs::Path &_path, double _resolution = 0.001);
+bool decodePath(const uint8_t *_data, size_t _data_size, nav_msgs::Path &_path);
+
+// Message form, frame id and stamp travel in the header of the message
+upat_follower::CompressedPath toCompressedPath(const nav_msgs::Path &_path, double _resolution = 0.001);
+nav_msgs::Path toPath(const upat_follower::CompressedPath &_compressed_path);
+
+}  // namespace upat_follower
+
+#endif /* PATH_CODEC_H */
\ No newline at end of file
@@ -0,0 +1,43 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef REFERENCE_DATA_H
+#define REFERENCE_DATA_H
+
+#include <nav_msgs/Path.h>
+#include <string>
+#include <vector>
+
+namespace upat_follower {
+
+struct ReferenceMission {
+    nav_msgs::Path init_path;
+    std::vector<double> times;  // Trajectory is skipped unless there is one time per waypoint
+    std::string folder;
+};
+
+// Write init.csv, trajectory.csv, interp1.csv, cubic_spline_loyal.csv and cubic_spline.csv of every mission into its
+// folder, the fixtures of tests_generator. Every file is generated on its own thread (all cores when _threads is
+// zero). Return false if any file could not be written.
+bool generateReferenceData(const std::vector<ReferenceMission> &_missions, int _threads = 0);
+
+}  // namespace upat_follower
+
+#endif /* REFERENCE_DATA_H */
\ No newline at end of file
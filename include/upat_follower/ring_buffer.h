@@ -0,0 +1,98 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace upat_follower {
+
+// Fixed capacity buffer that keeps the newest items. Only one of every _decimation pushed items is stored. Stored
+// items are numbered in order, so the ones added after a given sequence number can be read back.
+template <typename T>
+class RingBuffer {
+   public:
+    explicit RingBuffer(size_t _capacity = 1000, int _decimation = 1) {
+        setCapacity(_capacity);
+        setDecimation(_decimation);
+    }
+
+    void setCapacity(size_t _capacity) {
+        items_.assign(_capacity > 0 ? _capacity : 1, T());
+        clear();
+    }
+
+    void setDecimation(int _decimation) {
+        decimation_ = _decimation > 0 ? _decimation : 1;
+    }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+        offered_ = 0;
+        next_seq_ = 0;
+    }
+
+    // Return true if the item is stored, false if it is skipped by decimation
+    bool push(const T &_item) {
+        if (offered_++ % decimation_ != 0) return false;
+        items_[head_] = _item;
+        head_ = (head_ + 1) % items_.size();
+        if (size_ < items_.size()) size_++;
+        next_seq_++;
+        return true;
+    }
+
+    // Item _i counting from the oldest one stored
+    const T &operator[](size_t _i) const {
+        return items_[(head_ + items_.size() - size_ + _i) % items_.size()];
+    }
+
+    const T &back() const {
+        return (*this)[size_ - 1];
+    }
+
+    // Append the stored items with sequence number _seq or newer to _out, return the sequence number of the first
+    // one appended (greater than _seq if older items were already overwritten)
+    uint64_t copySince(uint64_t _seq, std::vector<T> &_out) const {
+        uint64_t first = _seq > firstSeq() ? _seq : firstSeq();
+        for (uint64_t s = first; s < next_seq_; s++) _out.push_back((*this)[s - firstSeq()]);
+        return first;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return items_.size(); }
+    bool empty() const { return size_ == 0; }
+    uint64_t firstSeq() const { return next_seq_ - size_; }
+    uint64_t nextSeq() const { return next_seq_; }
+
+   private:
+    std::vector<T> items_;
+    size_t head_, size_;
+    uint64_t offered_, next_seq_;
+    int decimation_;
+};
+
+}  // namespace upat_follower
+
+#endif /* RING_BUFFER_H */
\ No newline at end of file
@@ -0,0 +1,71 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <upat_follower/follower.h>
+#include <upat_follower/normal_distance.h>
+#include <Eigen/Eigen>
+#include <fstream>
+#include <random>
+#include "geometry_msgs/PoseStamped.h"
+#include "geometry_msgs/TwistStamped.h"
+#include "nav_msgs/Path.h"
+
+namespace upat_follower {
+
+// Kinematic UAV that tracks velocity commands with a first order lag, bounded acceleration and wind noise, used to
+// close the loop with the Follower without UAL, PX4 or Gazebo
+class Simulator {
+   public:
+    Simulator(double _lag = 0.3, double _max_acceleration = 3.0, double _wind_stddev = 0.0, int _seed = 0);
+    ~Simulator();
+
+    bool runMission(upat_follower::Follower &_follower, const nav_msgs::Path &_target_path, const nav_msgs::Path &_reference_path);
+    void saveNormalDistances(std::ofstream &_csv_normal_distances);
+    void reset(Eigen::Vector3d _position);
+    void step(const geometry_msgs::TwistStamped &_velocity, double _dt);
+    geometry_msgs::PoseStamped pose();
+    // Params
+    double rate_ = 30.0;
+    double reach_tolerance_ = 0.1;
+    double max_mission_time_ = 600.0;
+    // Mission results, one row per tick as Visualization::saveMissionData: time, normal distance to the target path
+    // and to the linear interpolation of the reference path
+    std::vector<Eigen::Vector3d> normal_distances_;
+    double mission_time_ = 0.0;
+    double mean_normal_distance_ = 0.0;
+    double rms_normal_distance_ = 0.0;
+    double max_normal_distance_ = 0.0;
+
+   private:
+    // Variables
+    double lag_, max_acceleration_, wind_stddev_;
+    double time_ = 0.0;
+    Eigen::Vector3d position_, velocity_;
+    std::mt19937 random_engine_;
+    std::normal_distribution<double> wind_distribution_;
+    std::string frame_id_;
+};
+
+}  // namespace upat_follower
+
+#endif /* SIMULATOR_H */
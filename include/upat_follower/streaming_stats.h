@@ -0,0 +1,75 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef STREAMING_STATS_H
+#define STREAMING_STATS_H
+
+#include <upat_follower/ErrorStats.h>
+#include <cstdint>
+
+namespace upat_follower {
+
+// Streaming estimate of the _p quantile in constant memory, P² algorithm (Jain and Chlamtac, 1985). The first five
+// samples are kept and the exact quantile is returned until then.
+class P2Quantile {
+   public:
+    explicit P2Quantile(double _p = 0.5);
+
+    void add(double _x);
+    void reset();
+    double value() const;
+
+   private:
+    double parabolic(int _i, double _d) const;
+    double linear(int _i, double _d) const;
+    // Variables
+    double p_;
+    uint32_t count_ = 0;
+    double heights_[5];
+    double positions_[5];
+    double desired_[5];
+    double increments_[5];
+};
+
+// Running count, mean, RMS, max and P50/P95/P99 of a distance
+class StreamingStats {
+   public:
+    StreamingStats();
+
+    void add(double _distance);
+    void reset();
+    uint32_t count() const { return count_; }
+    double mean() const;
+    double rms() const;
+    double max() const { return max_; }
+    upat_follower::ErrorStats toMsg() const;
+
+   private:
+    // Variables
+    uint32_t count_ = 0;
+    double sum_ = 0.0;
+    double sum_squared_ = 0.0;
+    double max_ = 0.0;
+    P2Quantile p50_, p95_, p99_;
+};
+
+}  // namespace upat_follower
+
+#endif /* STREAMING_STATS_H */
\ No newline at end of file
@@ -0,0 +1,75 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace upat_follower {
+
+// Scoped spans recorded into a ring buffer per thread and dumped as Chrome trace event JSON, which chrome://tracing
+// and ui.perfetto.dev open. Timestamps come from the system clock, so traces of different processes line up. When
+// tracing is disabled a span costs a relaxed atomic load.
+
+// Start recording, the last _ring_size spans of every thread are kept. The trace is written to _file_name when the
+// process exits, /tmp/upat_follower_trace_<pid>.json if empty
+void enableTracing(const std::string &_file_name = "", size_t _ring_size = 1 << 16);
+void disableTracing();
+// Do not write the trace when the process exits, spans are still recorded while tracing is enabled
+void cancelExitTrace();
+// Write the spans recorded so far, spans being recorded meanwhile may be lost
+bool dumpTrace(const std::string &_file_name);
+
+extern std::atomic<bool> tracing_enabled;
+
+inline bool isTracing() {
+    return tracing_enabled.load(std::memory_order_relaxed);
+}
+
+class TraceSpan {
+   public:
+    // _name must outlive the trace, string literals do
+    explicit TraceSpan(const char *_name) : name_(isTracing() ? _name : nullptr), begin_ns_(name_ ? now() : 0) {}
+    ~TraceSpan() {
+        if (name_) record(name_, begin_ns_, now());
+    }
+
+   private:
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+    static int64_t now();
+    static void record(const char *_name, int64_t _begin_ns, int64_t _end_ns);
+    // Variables
+    const char *name_;
+    int64_t begin_ns_;
+};
+
+}  // namespace upat_follower
+
+#define UPAT_TRACE_CONCAT_(a, b) a##b
+#define UPAT_TRACE_CONCAT(a, b) UPAT_TRACE_CONCAT_(a, b)
+// Span named _name from here to the end of the enclosing scope
+#define UPAT_TRACE_SCOPE(_name) upat_follower::TraceSpan UPAT_TRACE_CONCAT(upat_trace_span_, __LINE__)(_name)
+
+#endif /* TRACE_H */
\ No newline at end of file
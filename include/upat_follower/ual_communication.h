@@ -27,13 +27,27 @@
 #include <uav_abstraction_layer/TakeOff.h>
 #include <uav_abstraction_layer/ual.h>
 #include <upat_follower/GeneratePath.h>
-#include <upat_follower/PreparePath.h>
-#include <upat_follower/PrepareTrajectory.h>
+#include <upat_follower/GeneratePathShared.h>
+#include <upat_follower/GenerateTrajectoryShared.h>
+#include <upat_follower/LoadSharedPath.h>
+#include <upat_follower/PathIncrement.h>
+#include <upat_follower/PreparedPath.h>
 #include <upat_follower/Visualize.h>
 #include <upat_follower/follower.h>
 #include <upat_follower/generator.h>
+#include <upat_follower/mission_io.h>
+#include <upat_follower/path_cache.h>
+#include <upat_follower/reference_data.h>
+#include <upat_follower/ring_buffer.h>
+#include <upat_follower/streaming_stats.h>
+#include <upat_follower/trace.h>
 #include <Eigen/Eigen>
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <future>
+#include <memory>
+#include <sstream>
 #include "ecl/geometry.hpp"
 #include "geometry_msgs/PoseStamped.h"
 #include "nav_msgs/Path.h"
@@ -44,6 +58,7 @@ namespace upat_follower {
 class UALCommunication {
    public:
     UALCommunication();
+    UALCommunication(ros::NodeHandle _nh, ros::NodeHandle _pnh);
     ~UALCommunication();
 
     void runMission();
@@ -51,6 +66,16 @@ class UALCommunication {
     bool flag_hover_ = false;
 
    private:
+    enum mission_state_t { state_preparing_,
+                           state_taking_off_,
+                           state_going_to_start_,
+                           state_following_,
+                           state_going_to_end_,
+                           state_landing_ };
+    struct MissionLeg {
+        nav_msgs::Path init_path;
+        std::vector<double> times;
+    };
     double vxy_ = 2.0;
     double vz_up_ = 3.0;
     double vz_dn_ = 1.0;
@@ -59,31 +84,49 @@ class UALCommunication {
     void ualPoseCallback(const geometry_msgs::PoseStamped::ConstPtr &_ual_pose);
     void velocityCallback(const geometry_msgs::TwistStamped &_velocity);
     // Methods
-    nav_msgs::Path csvToPath(std::string _file_name);
-    std::vector<double> csvToVector(std::string _file_name);
-    nav_msgs::Path constructPath(std::vector<double> _wps_x, std::vector<double> _wps_y, std::vector<double> _wps_z, std::string frame_id);
     void saveDataForTesting();
+    PathCache prepareLeg(int _leg);
+    void prefetchNextLeg();
+    bool switchLeg();
+    void measureLoop();
+    uint64_t missionHash(int _leg);
+    std::string legCacheFile(int _leg);
     // Node handlers
     ros::NodeHandle nh_, pnh_;
     // Subscribers
     ros::Subscriber sub_pose_, sub_state_, sub_velocity_;
     // Publishers
-    ros::Publisher pub_set_velocity_, pub_set_pose_;
+    ros::Publisher pub_set_velocity_, pub_set_pose_, pub_current_path_increment_, pub_prepared_path_;
     // Services
-    ros::ServiceClient client_take_off_, client_land_, client_generate_path_, client_prepare_path_, client_prepare_trajectory_, client_visualize_;
+    ros::ServiceClient client_take_off_, client_land_, client_generate_path_, client_generate_path_shared_, client_generate_trajectory_shared_, client_load_shared_path_, client_visualize_;
     // Variables
     std::string folder_data_name_;
-    bool on_path_, end_path_;
-    nav_msgs::Path target_path_, vel_percentage_path_, init_path_, current_path_;
+    mission_state_t mission_state_;
+    std::vector<MissionLeg> legs_;
+    int current_leg_ = 0;
+    int prepared_leg_ = 0;
+    std::string prepared_handle_;  // Shared memory segment of the prepared leg, without use_class
+    std::future<PathCache> prepare_future_;
+    std::future<bool> take_off_future_, land_future_;
+    StreamingStats loop_jitter_;  // Deviation from the pub_rate period in microseconds
+    int late_loops_ = 0;
+    std::chrono::steady_clock::time_point last_loop_, last_loop_report_;
+    nav_msgs::Path target_path_, vel_percentage_path_, init_path_;
+    RingBuffer<geometry_msgs::PoseStamped> current_path_;
+    uint64_t synced_seq_ = 0;
+    bool paths_changed_ = false;
     geometry_msgs::PoseStamped ual_pose_;
     geometry_msgs::TwistStamped velocity_;
     uav_abstraction_layer::State ual_state_;
     std::vector<double> times_;
+    std::unique_ptr<upat_follower::Follower> follower_;
     // Params
     int uav_id_, generator_mode_;
-    bool save_test_, trajectory_, use_class_;
-    double reach_tolerance_;
-    std::string init_path_name_;
+    bool save_test_, trajectory_, use_class_, in_process_;
+    double reach_tolerance_, pub_rate_, loop_report_period_;
+    int trail_capacity_, trail_decimation_;
+    std::string init_path_name_, legs_names_;
+    std::string path_cache_;
     std::string pkg_name_ = "upat_follower";
 };
 
@@ -21,54 +21,87 @@
 #include <ros/ros.h>
 #include <uav_abstraction_layer/State.h>
 #include <uav_abstraction_layer/ual.h>
+#include <upat_follower/PathIncrement.h>
+#include <upat_follower/PreparedPath.h>
+#include <upat_follower/TrackingStats.h>
 #include <upat_follower/Visualize.h>
 #include <upat_follower/generator.h>
+#include <upat_follower/mission_log.h>
+#include <upat_follower/normal_distance.h>
+#include <upat_follower/ring_buffer.h>
+#include <upat_follower/streaming_stats.h>
+#include <upat_follower/trace.h>
 #include <visualization_msgs/Marker.h>
 #include <Eigen/Eigen>
-#include <fstream>
 #include <ctime>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <sys/stat.h>
 #include "geometry_msgs/PoseStamped.h"
 #include "nav_msgs/Path.h"
 
 class Visualization {
    public:
     Visualization();
+    Visualization(ros::NodeHandle _nh, ros::NodeHandle _pnh);
     ~Visualization();
 
     bool save_experiment = false;
     nav_msgs::Path current_path_;
     uav_abstraction_layer::State ual_state_;
-    std::ofstream csv_normal_distances_, csv_current_path_;
 
     void pubMsgs();
-    void saveMissionData();
+    void saveMissionData(double _normal_dist_generated_path, double _normal_dist_init_path);
+    void update();
+    void openExperimentFiles(bool _trajectory, int _generator_mode);
+    void closeExperimentFiles();
 
    private:
     // Callbacks
     void ualStateCallback(const uav_abstraction_layer::State &_ual_state);
     void ualPoseCallback(const geometry_msgs::PoseStamped::ConstPtr &_ual_pose);
+    void currentPathIncrementCallback(const upat_follower::PathIncrement::ConstPtr &_increment);
+    void preparedPathCallback(const upat_follower::PreparedPath::ConstPtr &_prepared_path);
     bool visualCallback(upat_follower::Visualize::Request &_req_visual, upat_follower::Visualize::Response &_res_visual);
     // Methods
-    int calculateDistanceOnPath(int _prev_normal_pos_on_path, double _meters, nav_msgs::Path _path_search);
-    int calculateNormalDistance(Eigen::Vector3f _current_point, double _search_range, int _prev_normal_pos_on_path, nav_msgs::Path _path_search);
     visualization_msgs::Marker readModel(std::string _model_type);
+    void setPaths(const nav_msgs::Path &_init_path, const nav_msgs::Path &_generated_path);
+    void appendCurrentPath(uint64_t _first_seq, const std::vector<geometry_msgs::PoseStamped> &_poses, const std::string &_frame_id);
+    void resetCurrentPath();
+    nav_msgs::Path decimatePath(const nav_msgs::Path &_path);
+    void measureTracking();
+    void pubTrackingStats();
     // Node handlers
     ros::NodeHandle nh_, pnh_;
     // Subscribers
-    ros::Subscriber sub_pose_, sub_state_;
+    ros::Subscriber sub_pose_, sub_state_, sub_current_path_increment_, sub_prepared_path_;
     // Publishers
-    ros::Publisher pub_init_path_, pub_generated_path_, pub_current_path_, pub_uav_model_;
+    ros::Publisher pub_init_path_, pub_generated_path_, pub_current_path_, pub_uav_model_, pub_trail_, pub_tracking_stats_;
     // Services
     ros::ServiceServer server_visualize_;
     // Variables
     geometry_msgs::PoseStamped ual_pose_;
     nav_msgs::Path generated_path_, init_path_, interp1_path_;
     visualization_msgs::Marker uav_model_;
-    std::vector<double> normal_dist_generated_path_, normal_dist_init_path_;
-    double normal_distance_;
-    int prev_normal_pos_on_init_path_ = 0;
-    int prev_normal_pos_on_generated_path_ = 0;
+    upat_follower::MissionLog mission_log_;
+    std::string mission_log_file_;
+    upat_follower::NormalDistance normal_distance_generated_path_, normal_distance_init_path_;
+    upat_follower::StreamingStats generated_path_stats_, init_path_stats_;
+    std::vector<upat_follower::StreamingStats> segment_stats_;
+    bool interp1_outdated_ = false;
+    ros::Time last_stats_pub_;
+    upat_follower::RingBuffer<geometry_msgs::PoseStamped> current_trail_;
+    uint64_t current_path_seq_ = 0;
+    visualization_msgs::Marker trail_chunk_;
+    bool paths_changed_ = false;
+    bool trail_changed_ = false;
+    bool current_path_changed_ = false;
+    ros::Time last_current_path_pub_;
+    double start_time_;
+    bool do_once_ = true;
     // Params
-    int uav_id_;
+    int uav_id_, trail_capacity_, max_path_points_, trail_chunk_size_;
+    double current_path_rate_, log_flush_period_, stats_rate_;
     std::string model_;
 };
\ No newline at end of file
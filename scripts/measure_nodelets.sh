@@ -0,0 +1,45 @@
+#!/bin/bash
+# Flies the same mission as separate nodes (mision_ual with use_class off) and as nodelets in one manager
+# (mision_nodelet), and compares the CPU used by the upat_follower processes and the delay of the output velocity.
+# The delay goes from the follower publishing output_vel to rostopic receiving it from ual_communication on
+# set_velocity, so it also holds the wait for the ual_communication tick, the same in both runs.
+# Needs a sourced workspace and the simulator used by the launches.
+#
+# usage: rosrun upat_follower measure_nodelets.sh [seconds] [path]
+
+DURATION=${1:-60}
+MISSION_PATH=${2:-cubic}
+VELOCITY_TOPIC=/uav_1/ual/set_velocity
+OUT=$(mktemp -d /tmp/upat_follower_measure_XXXXXX)
+
+# measure <name> <process pattern> <launch file> [launch args]
+measure() {
+    local name=$1
+    local pattern=$2
+    shift 2
+    roslaunch upat_follower "$@" path:=$MISSION_PATH > $OUT/$name.launch.log 2>&1 &
+    local launch_pid=$!
+    # Following the path once ual_communication forwards the first velocity
+    if ! timeout 300 rostopic echo -n 1 $VELOCITY_TOPIC > /dev/null; then
+        echo "$name: no velocity on $VELOCITY_TOPIC, see $OUT/$name.launch.log"
+        kill -INT $launch_pid
+        wait $launch_pid
+        return 1
+    fi
+    local pids=$(pgrep -d, -f "$pattern")
+    timeout -s INT $DURATION rostopic delay $VELOCITY_TOPIC > $OUT/$name.delay.log 2>&1 &
+    local delay_pid=$!
+    top -b -d 1 -n $((DURATION + 1)) -p $pids > $OUT/$name.top.log
+    wait $delay_pid
+    kill -INT $launch_pid
+    wait $launch_pid
+    # %CPU of all the processes added up per sample, the first sample is the average since they started
+    local cpu=$(awk '/^top -/ { if (n > 1) sum += c; c = 0; n++ } $1 ~ /^[0-9]+$/ { c += $9 } END { if (n > 1) sum += c; printf "%.1f", (n > 1 ? sum / (n - 1) : 0) }' $OUT/$name.top.log)
+    local delay=$(awk '/average delay/ { d = $3 } END { printf "%.2f", d * 1000 }' $OUT/$name.delay.log)
+    local delay_max=$(awk '/max:/ { m = $4 } END { sub("s", "", m); printf "%.2f", m * 1000 }' $OUT/$name.delay.log)
+    printf "%-8s cpu %6s %%  delay mean %6s ms  max %6s ms\n" $name $cpu $delay $delay_max | tee -a $OUT/summary.txt
+}
+
+measure nodes "(generator|follower|ual_communication|visualization)_node" mision_ual.launch use_class:=false multi:=false
+measure nodelets "nodelet (manager|load upat_follower)" mision_nodelet.launch
+echo "Logs in $OUT"
@@ -0,0 +1,56 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <upat_follower/flat_path.h>
+#include <algorithm>
+
+namespace upat_follower {
+
+upat_follower::FlatPath toFlatPath(const nav_msgs::Path &_path) {
+    upat_follower::FlatPath flat_path;
+    flat_path.header = _path.header;
+    flat_path.x.resize(_path.poses.size());
+    flat_path.y.resize(_path.poses.size());
+    flat_path.z.resize(_path.poses.size());
+    for (size_t i = 0; i < _path.poses.size(); i++) {
+        flat_path.x[i] = _path.poses[i].pose.position.x;
+        flat_path.y[i] = _path.poses[i].pose.position.y;
+        flat_path.z[i] = _path.poses[i].pose.position.z;
+    }
+
+    return flat_path;
+}
+
+nav_msgs::Path toPath(const upat_follower::FlatPath &_flat_path) {
+    nav_msgs::Path path;
+    path.header = _flat_path.header;
+    size_t size = std::min(_flat_path.x.size(), std::min(_flat_path.y.size(), _flat_path.z.size()));
+    path.poses.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        path.poses[i].pose.position.x = _flat_path.x[i];
+        path.poses[i].pose.position.y = _flat_path.y[i];
+        path.poses[i].pose.position.z = _flat_path.z[i];
+        path.poses[i].pose.orientation.w = 1;
+    }
+
+    return path;
+}
+
+}  // namespace upat_follower
\ No newline at end of file
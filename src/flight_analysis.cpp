@@ -0,0 +1,81 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <upat_follower/flight_analysis.h>
+#include <upat_follower/normal_distance.h>
+#include <upat_follower/streaming_stats.h>
+#include <algorithm>
+#include <limits>
+
+namespace upat_follower {
+
+namespace {
+
+float segmentDistance(const Eigen::Vector3f &_point, const nav_msgs::Path &_path, int _i) {
+    Eigen::Vector3f a(_path.poses[_i].pose.position.x, _path.poses[_i].pose.position.y, _path.poses[_i].pose.position.z);
+    Eigen::Vector3f b(_path.poses[_i + 1].pose.position.x, _path.poses[_i + 1].pose.position.y, _path.poses[_i + 1].pose.position.z);
+    Eigen::Vector3f ab = b - a;
+    float t = ab.squaredNorm() > 0 ? std::min(1.0f, std::max(0.0f, (_point - a).dot(ab) / ab.squaredNorm())) : 0.0f;
+
+    return (a + t * ab - _point).norm();
+}
+
+}  // namespace
+
+double crossTrackError(const Eigen::Vector3f &_point, const nav_msgs::Path &_path, int _closest) {
+    if (_path.poses.size() < 2) return 0.0;
+    // The foot of the perpendicular is on one of the two segments that share the closest pose
+    double error = std::numeric_limits<double>::max();
+    if (_closest > 0) error = segmentDistance(_point, _path, _closest - 1);
+    if (_closest + 1 < _path.poses.size()) error = std::min<double>(error, segmentDistance(_point, _path, _closest));
+
+    return error;
+}
+
+FlightMetrics analyseFlight(const nav_msgs::Path &_flight, const nav_msgs::Path &_reference, const std::vector<double> &_times, double _goal_tolerance) {
+    FlightMetrics metrics;
+    metrics.samples = _flight.poses.size();
+    if (!_times.empty()) metrics.completion_time = _times.back();
+    if (_flight.poses.empty() || _reference.poses.empty()) return metrics;
+    NormalDistance normal_distance;
+    StreamingStats normal_stats, cross_track_stats;
+    for (int i = 0; i < _flight.poses.size(); i++) {
+        Eigen::Vector3f point(_flight.poses[i].pose.position.x, _flight.poses[i].pose.position.y, _flight.poses[i].pose.position.z);
+        normal_stats.add(normal_distance.calculate(point, _reference));
+        cross_track_stats.add(crossTrackError(point, _reference, normal_distance.normal_pos_on_path_));
+    }
+    upat_follower::ErrorStats normal_msg = normal_stats.toMsg();
+    upat_follower::ErrorStats cross_track_msg = cross_track_stats.toMsg();
+    metrics.mean_normal_distance = normal_msg.mean;
+    metrics.rms_normal_distance = normal_msg.rms;
+    metrics.max_normal_distance = normal_msg.max;
+    metrics.p95_normal_distance = normal_msg.p95;
+    metrics.mean_cross_track = cross_track_msg.mean;
+    metrics.rms_cross_track = cross_track_msg.rms;
+    metrics.max_cross_track = cross_track_msg.max;
+    metrics.p95_cross_track = cross_track_msg.p95;
+    const geometry_msgs::Point &last = _flight.poses.back().pose.position;
+    const geometry_msgs::Point &goal = _reference.poses.back().pose.position;
+    metrics.completed = Eigen::Vector3d(last.x - goal.x, last.y - goal.y, last.z - goal.z).norm() <= _goal_tolerance;
+
+    return metrics;
+}
+
+}  // namespace upat_follower
\ No newline at end of file
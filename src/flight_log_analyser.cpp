@@ -0,0 +1,157 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ros/ros.h>
+#include <upat_follower/cli.h>
+#include <upat_follower/flight_analysis.h>
+#include <upat_follower/mission_io.h>
+#include <upat_follower/parallel.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+// Tracking metrics of every flight logged by visualization (save_experiment_data) under a folder, in parallel:
+// $ rosrun upat_follower flight_log_analyser --logs data/log --reference tests/splines --output summary.csv
+// A flight is a current_path_<mode>.csv or current_trajectory.csv file, with the normal_dist_<mode>.csv of the same
+// folder for the completion time. The reference path (interp1.csv, cubic_spline_loyal.csv, cubic_spline.csv or
+// trajectory.csv, as written by reference_data_generator) is taken from the folder of the flight if it is there, from
+// --reference otherwise.
+
+struct Flight {
+    std::string folder, mode;
+    upat_follower::FlightMetrics metrics;
+    bool analysed = false;
+};
+
+void findFlights(const std::string &_folder, std::vector<Flight> &_flights) {
+    DIR *dir = opendir(_folder.c_str());
+    if (!dir) return;
+    std::vector<std::string> folders;
+    for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        std::string path = _folder + "/" + name;
+        Flight flight;
+        flight.folder = _folder;
+        if (name == "current_trajectory.csv") {
+            flight.mode = "trajectory";
+        } else if (upat_follower::startsWith(name, "current_path_") && upat_follower::endsWith(name, ".csv")) {
+            flight.mode = name.substr(13, name.size() - 17);
+        } else {
+            struct stat file_stat;
+            if (stat(path.c_str(), &file_stat) == 0 && S_ISDIR(file_stat.st_mode)) folders.push_back(path);
+            continue;
+        }
+        _flights.push_back(flight);
+    }
+    closedir(dir);
+    for (int i = 0; i < folders.size(); i++) findFlights(folders[i], _flights);
+}
+
+int main(int _argc, char **_argv) {
+    // No master is needed: nothing is advertised and rosout is disabled
+    ros::init(_argc, _argv, "flight_log_analyser", ros::init_options::AnonymousName | ros::init_options::NoRosout | ros::init_options::NoSigintHandler);
+
+    std::map<std::string, std::string> args;
+    args["reference"] = ".";
+    args["threads"] = "0";
+    args["goal_tolerance"] = "1.0";
+    upat_follower::parseArgs(_argc, _argv, args);
+    if (args["logs"].empty()) {
+        std::cerr << "Usage: flight_log_analyser --logs <folder> [--reference <folder>] [--output <summary.csv>]" << std::endl
+                  << "       [--goal_tolerance m] [--threads n]" << std::endl;
+        return 2;
+    }
+    std::map<std::string, std::string> reference_files;
+    reference_files["linear_interp"] = "interp1.csv";
+    reference_files["cubic_loyal_spline"] = "cubic_spline_loyal.csv";
+    reference_files["cubic_spline"] = "cubic_spline.csv";
+    reference_files["trajectory"] = "trajectory.csv";
+
+    std::vector<Flight> flights;
+    findFlights(args["logs"], flights);
+    std::sort(flights.begin(), flights.end(), [](const Flight &_a, const Flight &_b) {
+        return _a.folder != _b.folder ? _a.folder < _b.folder : _a.mode < _b.mode;
+    });
+    // The references of --reference are shared by all the flights, read them once
+    std::map<std::string, nav_msgs::Path> references;
+    for (std::map<std::string, std::string>::iterator it = reference_files.begin(); it != reference_files.end(); ++it) {
+        std::string file_name = args["reference"] + "/" + it->second;
+        if (upat_follower::isFile(file_name)) references[it->first] = upat_follower::csvToPath(file_name);
+    }
+
+    double goal_tolerance = std::atof(args["goal_tolerance"].c_str());
+    auto begin = std::chrono::steady_clock::now();
+    upat_follower::parallelFor(flights.size(), [&](int _i) {
+        Flight &flight = flights[_i];
+        if (reference_files.count(flight.mode) == 0) return;
+        nav_msgs::Path reference;
+        std::string reference_file = flight.folder + "/" + reference_files.at(flight.mode);
+        if (upat_follower::isFile(reference_file)) {
+            reference = upat_follower::csvToPath(reference_file);
+        } else if (references.count(flight.mode) > 0) {
+            reference = references.at(flight.mode);
+        } else {
+            return;
+        }
+        std::string flight_file = flight.folder + (flight.mode == "trajectory" ? "/current_trajectory.csv" : "/current_path_" + flight.mode + ".csv");
+        std::vector<double> times;
+        std::string normal_dist_file = flight.folder + "/normal_dist_" + flight.mode + ".csv";
+        if (upat_follower::isFile(normal_dist_file)) upat_follower::readCsv(normal_dist_file, 1, times);
+        flight.metrics = upat_follower::analyseFlight(upat_follower::csvToPath(flight_file), reference, times, goal_tolerance);
+        flight.analysed = true;
+    }, std::atoi(args["threads"].c_str()));
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::stringstream summary;
+    summary << std::fixed << std::setprecision(5)
+            << "folder,mode,samples,completed,completion_time,mean_normal_dist,rms_normal_dist,max_normal_dist,p95_normal_dist,"
+            << "mean_cross_track,rms_cross_track,max_cross_track,p95_cross_track" << std::endl;
+    int analysed = 0;
+    for (int i = 0; i < flights.size(); i++) {
+        const Flight &flight = flights[i];
+        if (!flight.analysed) {
+            std::cerr << "No reference path for " << flight.folder << " (" << flight.mode << "), skipped" << std::endl;
+            continue;
+        }
+        const upat_follower::FlightMetrics &metrics = flight.metrics;
+        summary << flight.folder << "," << flight.mode << "," << metrics.samples << "," << metrics.completed << "," << metrics.completion_time << ","
+                << metrics.mean_normal_distance << "," << metrics.rms_normal_distance << "," << metrics.max_normal_distance << "," << metrics.p95_normal_distance << ","
+                << metrics.mean_cross_track << "," << metrics.rms_cross_track << "," << metrics.max_cross_track << "," << metrics.p95_cross_track << std::endl;
+        analysed++;
+    }
+    if (args["output"].empty()) {
+        std::cout << summary.str();
+    } else {
+        std::ofstream csv_summary(args["output"]);
+        csv_summary << summary.str();
+    }
+    std::cout << analysed << " flights in " << elapsed << " s" << std::endl;
+
+    return analysed > 0 ? 0 : 1;
+}
\ No newline at end of file
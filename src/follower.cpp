@@ -19,20 +19,41 @@
 //----------------------------------------------------------------------------------------------------------------------
 
 #include <upat_follower/follower.h>
+#include <boost/make_shared.hpp>
+#include <utility>
 
 namespace upat_follower {
 
-Follower::Follower() : nh_(), pnh_("~") {
+Follower::Follower() : Follower(ros::NodeHandle(), ros::NodeHandle("~")) {
+}
+
+Follower::Follower(ros::NodeHandle _nh, ros::NodeHandle _pnh) : nh_(_nh), pnh_(_pnh) {
     // Parameters
     pnh_.getParam("uav_id", uav_id_);
     pnh_.getParam("debug", debug_);
+    pnh_.param<bool>("diagnostics", diagnostics_, false);
+    pnh_.param<double>("diagnostics_rate", diagnostics_rate_, 1.0);
+    double pub_rate;
+    pnh_.param<double>("pub_rate", pub_rate, 30.0);
+    if (pub_rate > 0) search_tick_period_ = 1.0 / pub_rate;
+    pnh_.param<double>("search_safety_factor", search_safety_factor_, 2.0);
+    pnh_.param<double>("search_margin", search_margin_, 0.5);
+    bool trace = false;
+    std::string trace_file;
+    pnh_.param<bool>("trace", trace, false);
+    pnh_.param<std::string>("trace_file", trace_file, "");
+    if (trace) enableTracing(trace_file);
     // Subscriptions
     sub_pose_ = nh_.subscribe("/uav_" + std::to_string(uav_id_) + "/ual/pose", 0, &Follower::ualPoseCallback, this);
+    sub_prepared_path_ = nh_.subscribe("/upat_follower/ual_communication/uav_" + std::to_string(uav_id_) + "/prepared_path", 1, &Follower::preparedPathCallback, this);
     // Publishers
     pub_output_velocity_ = nh_.advertise<geometry_msgs::TwistStamped>("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/output_vel", 1000);
     // Services
     server_prepare_path_ = nh_.advertiseService("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/prepare_path", &Follower::preparePathCb, this);
     server_prepare_trajectory_ = nh_.advertiseService("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/prepare_trajectory", &Follower::prepareTrajectoryCb, this);
+    server_prepare_path_flat_ = nh_.advertiseService("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/prepare_path_flat", &Follower::preparePathFlatCb, this);
+    server_prepare_trajectory_flat_ = nh_.advertiseService("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/prepare_trajectory_flat", &Follower::prepareTrajectoryFlatCb, this);
+    server_load_shared_path_ = nh_.advertiseService("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/load_shared_path", &Follower::loadSharedPathCb, this);
     // Debug follower
     if (debug_) {
         pub_point_look_ahead_ = nh_.advertise<geometry_msgs::PointStamped>("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/debug_point_look_ahead", 1000);
@@ -40,12 +61,20 @@ Follower::Follower() : nh_(), pnh_("~") {
         pub_point_search_normal_begin_ = nh_.advertise<geometry_msgs::PointStamped>("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/debug_point_search_begin", 1000);
         pub_point_search_normal_end_ = nh_.advertise<geometry_msgs::PointStamped>("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/debug_point_search_end", 1000);
     }
+    // Diagnostics follower
+    if (diagnostics_) {
+        pub_diagnostics_ = nh_.advertise<upat_follower::FollowerDiagnostics>("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/diagnostics", 10);
+    }
     capMaxVelocities();
 }
 
-Follower::Follower(int _uav_id, bool _debug) {
+Follower::Follower(int _uav_id, bool _debug, bool _diagnostics) {
     debug_ = _debug;
+    diagnostics_ = _diagnostics;
     uav_id_ = _uav_id;
+    if (diagnostics_) {
+        pub_diagnostics_ = nh_.advertise<upat_follower::FollowerDiagnostics>("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/diagnostics", 10);
+    }
     capMaxVelocities();
 }
 
@@ -54,11 +83,13 @@ Follower::~Follower() {
 
 void Follower::updatePath(nav_msgs::Path _new_target_path) {
     target_path_ = _new_target_path;
+    buildLookAheadTable();
 }
 
 void Follower::updateTrajectory(nav_msgs::Path _new_target_path, nav_msgs::Path _new_target_vel_path) {
     target_path_ = _new_target_path;
     target_vel_path_ = _new_target_vel_path;
+    buildLookAheadTable();
 }
 
 bool Follower::updatePathCb(upat_follower::UpdatePath::Request &_req_path, upat_follower::UpdatePath::Response &_res_path) {
@@ -71,16 +102,83 @@ bool Follower::updateTrajectoryCb(upat_follower::UpdateTrajectory::Request &_req
     return true;
 }
 
-nav_msgs::Path Follower::preparePath(nav_msgs::Path _init_path, int _generator_mode, double _look_ahead, double _cruising_speed) {
+void Follower::setMaxVelocities(double _vxy, double _vz_up, double _vz_dn) {
+    vxy_ = _vxy;
+    vz_up_ = _vz_up;
+    vz_dn_ = _vz_dn;
+    capMaxVelocities();
+}
+
+void Follower::loadPath(nav_msgs::Path _target_path, double _look_ahead, double _cruising_speed) {
     follower_mode_ = 0;
-    upat_follower::Generator generator(vxy_, vz_up_, vz_dn_, debug_);
-    generator.generatePath(_init_path, _generator_mode);
     look_ahead_ = _look_ahead;
     cruising_speed_ = _cruising_speed;
     if (_cruising_speed > smallest_max_velocity_) cruising_speed_ = smallest_max_velocity_;
     if (_cruising_speed <= 0) cruising_speed_ = 0.1;
-    target_path_ = generator.out_path_;
-    return generator.out_path_;
+    target_path_ = std::move(_target_path);
+    resetSearch();
+    buildLookAheadTable();
+}
+
+nav_msgs::Path Follower::preparePath(nav_msgs::Path _init_path, int _generator_mode, double _look_ahead, double _cruising_speed) {
+    upat_follower::Generator generator(vxy_, vz_up_, vz_dn_, debug_);
+    nav_msgs::Path generated_path = generator.generatePath(_init_path, _generator_mode, generator_workspace_).generated_path;
+    loadPath(generated_path, _look_ahead, _cruising_speed);
+    generator_mode_ = _generator_mode;
+    return generated_path;
+}
+
+void Follower::loadTrajectory(nav_msgs::Path _target_path, std::vector<double> _speed_percentages, double _max_velocity) {
+    follower_mode_ = 1;
+    generated_times_ = std::move(_speed_percentages);
+    max_vel_ = _max_velocity;
+    target_vel_path_ = nav_msgs::Path();
+    target_vel_path_.header.frame_id = _target_path.header.frame_id;
+    target_path_ = std::move(_target_path);
+    resetSearch();
+    buildLookAheadTable();
+}
+
+bool Follower::loadPathCache(const PathCache &_cache, double _look_ahead, double _cruising_speed) {
+    // Generated with other velocity limits, it would not be the path generated now
+    if (_cache.vxy_ != vxy_ || _cache.vz_up_ != vz_up_ || _cache.vz_dn_ != vz_dn_) return false;
+    if (_cache.generator_mode_ == PathCache::trajectory_mode_) {
+        if (_cache.speed_.size() != _cache.path_.poses.size()) return false;
+        loadTrajectory(_cache.path_, _cache.speed_, _cache.max_velocity_);
+    } else {
+        loadPath(_cache.path_, _look_ahead, _cruising_speed);
+        generator_mode_ = _cache.generator_mode_;
+    }
+
+    return true;
+}
+
+std::pair<int, int> Follower::getSearchWindow() {
+    return std::make_pair(start_search_pos_on_path_, end_search_pos_on_path_);
+}
+
+int Follower::getPosLookAhead(int _pos_on_path, bool _use_table) {
+    if (follower_mode_ == 1) {
+        look_ahead_ = changeLookAhead(_pos_on_path) /* 0.4 */;
+        if (_use_table && _pos_on_path < look_ahead_table_.size()) return look_ahead_table_[_pos_on_path];
+    }
+
+    return calculatePosLookAhead(_pos_on_path);
+}
+
+PathCache Follower::getPathCache() {
+    PathCache cache;
+    cache.generator_mode_ = follower_mode_ == 1 ? PathCache::trajectory_mode_ : generator_mode_;
+    cache.vxy_ = vxy_;
+    cache.vz_up_ = vz_up_;
+    cache.vz_dn_ = vz_dn_;
+    cache.path_ = target_path_;
+    if (follower_mode_ == 1) {
+        cache.max_velocity_ = max_vel_;
+        cache.speed_.assign(generated_times_.begin(), generated_times_.begin() + std::min(generated_times_.size(), target_path_.poses.size()));
+    }
+
+    return cache;
 }
 
 std::vector<double> Follower::timesToMaxVelPercentage(nav_msgs::Path _init_path, std::vector<double> _times) {
@@ -104,24 +202,26 @@ nav_msgs::Path Follower::prepareTrajectory(nav_msgs::Path _init_path, std::vecto
     follower_mode_ = 1;
     timesToMaxVelPercentage(_init_path, _times);
     upat_follower::Generator generator(vxy_, vz_up_, vz_dn_, debug_);
-    generator.generateTrajectory(_init_path, timesToMaxVelPercentage(_init_path, _times));
-    target_vel_path_ = generator.generated_path_vel_percentage_;
-    target_vel_path_.header.frame_id = generator.out_path_.header.frame_id;
-    for (int i = 0; i < generator.generated_times_.size(); i++) {
-        generated_times_.push_back(generator.generated_times_.at(i));
-    }
-    max_vel_ = generator.max_velocity_;
-    target_path_ = generator.out_path_;
-    return generator.out_path_;
+    GeneratorResult generated = generator.generateTrajectory(_init_path, timesToMaxVelPercentage(_init_path, _times), generator_workspace_);
+    target_vel_path_ = generated.generated_path_vel_percentage;
+    target_vel_path_.header.frame_id = generated.generated_path.header.frame_id;
+    generated_times_ = generated.generated_times;
+    max_vel_ = generated.max_velocity;
+    target_path_ = generated.generated_path;
+    resetSearch();
+    buildLookAheadTable();
+    return generated.generated_path;
 }
 
 bool Follower::preparePathCb(upat_follower::PreparePath::Request &_req_path, upat_follower::PreparePath::Response &_res_path) {
+    UPAT_TRACE_SCOPE("Follower::preparePathCb");
     _res_path.generated_path = preparePath(_req_path.init_path, _req_path.generator_mode.data, _req_path.look_ahead.data, _req_path.cruising_speed.data);
 
     return true;
 }
 
 bool Follower::prepareTrajectoryCb(upat_follower::PrepareTrajectory::Request &_req_trajectory, upat_follower::PrepareTrajectory::Response &_res_trajectory) {
+    UPAT_TRACE_SCOPE("Follower::prepareTrajectoryCb");
     std::vector<double> vec_times;
     for (int i = 0; i < _req_trajectory.times.size(); i++) {
         vec_times.push_back(_req_trajectory.times.at(i).data);
@@ -131,10 +231,62 @@ bool Follower::prepareTrajectoryCb(upat_follower::PrepareTrajectory::Request &_r
     return true;
 }
 
+bool Follower::preparePathFlatCb(upat_follower::PreparePathFlat::Request &_req_path, upat_follower::PreparePathFlat::Response &_res_path) {
+    UPAT_TRACE_SCOPE("Follower::preparePathFlatCb");
+    _res_path.generated_path = toFlatPath(preparePath(toPath(_req_path.init_path), _req_path.generator_mode, _req_path.look_ahead, _req_path.cruising_speed));
+
+    return true;
+}
+
+bool Follower::prepareTrajectoryFlatCb(upat_follower::PrepareTrajectoryFlat::Request &_req_trajectory, upat_follower::PrepareTrajectoryFlat::Response &_res_trajectory) {
+    UPAT_TRACE_SCOPE("Follower::prepareTrajectoryFlatCb");
+    std::vector<double> vec_times(_req_trajectory.times.begin(), _req_trajectory.times.end());
+    _res_trajectory.generated_path = toFlatPath(prepareTrajectory(toPath(_req_trajectory.init_path), vec_times));
+
+    return true;
+}
+
+bool Follower::loadSharedPathCb(upat_follower::LoadSharedPath::Request &_req_path, upat_follower::LoadSharedPath::Response &_res_path) {
+    // Path generated by the generator node, read from its shared memory segment instead of a service response. The
+    // segment is decoded once into the follower path, which is moved in without further copies
+    PathCache cache;
+    _res_path.success = false;
+    if (!loadSharedPathCache(_req_path.handle, cache)) return true;
+    if (cache.hash_ != _req_path.version) {
+        ROS_ERROR("Shared path %s holds another version", _req_path.handle.c_str());
+        return true;
+    }
+    if (cache.generator_mode_ == PathCache::trajectory_mode_) {
+        if (cache.speed_.size() != cache.path_.poses.size()) return true;
+        loadTrajectory(std::move(cache.path_), std::move(cache.speed_), cache.max_velocity_);
+    } else {
+        loadPath(std::move(cache.path_), _req_path.look_ahead, _req_path.cruising_speed);
+        generator_mode_ = cache.generator_mode_;
+    }
+    _res_path.success = true;
+
+    return true;
+}
+
 void Follower::ualPoseCallback(const geometry_msgs::PoseStamped::ConstPtr &_ual_pose) {
     ual_pose_ = *_ual_pose;
 }
 
+void Follower::preparedPathCallback(const upat_follower::PreparedPath::ConstPtr &_prepared_path) {
+    // Published by ual_communication in the same nodelet manager, the message is shared and only copied here
+    if (_prepared_path->path.poses.empty()) return;
+    if (_prepared_path->generator_mode == PathCache::trajectory_mode_) {
+        if (_prepared_path->speed_percentages.size() != _prepared_path->path.poses.size()) {
+            ROS_ERROR("Prepared trajectory has %d velocity percentages for %d poses", static_cast<int>(_prepared_path->speed_percentages.size()), static_cast<int>(_prepared_path->path.poses.size()));
+            return;
+        }
+        loadTrajectory(_prepared_path->path, _prepared_path->speed_percentages, _prepared_path->max_velocity);
+    } else {
+        loadPath(_prepared_path->path, _prepared_path->look_ahead, _prepared_path->cruising_speed);
+        generator_mode_ = _prepared_path->generator_mode;
+    }
+}
+
 void Follower::updatePose(const geometry_msgs::PoseStamped &_ual_pose) {
     ual_pose_ = _ual_pose;
 }
@@ -154,23 +306,70 @@ void Follower::capMaxVelocities() {
     smallest_max_velocity_ = *std::min_element(velocities.begin(), velocities.end());
 }
 
-int Follower::calculatePosOnPath(Eigen::Vector3f _current_point, double _search_range, int _prev_normal_pos_on_path, nav_msgs::Path _path_search) {
+void Follower::resetSearch() {
+    // A new path is searched from its beginning, the measured speed is kept
+    prev_normal_pos_on_path_ = 0;
+    prev_normal_vel_on_path_ = 0;
+    start_search_pos_on_path_ = 0;
+    end_search_pos_on_path_ = 0;
+    prev_pos_look_ahead_ = -1;
+}
+
+double Follower::calculateSearchRange(Eigen::Vector3f _current_point) {
+    double displacement = 0.0;
+    if (has_prev_point_) {
+        displacement = (_current_point - prev_point_).norm();
+        // Use pose stamps when available, fall back on the nominal tick period otherwise
+        double elapsed = (ual_pose_.header.stamp - prev_stamp_).toSec();
+        if (elapsed <= 0) elapsed = search_tick_period_;
+        measured_speed_ = displacement / elapsed;
+    }
+    prev_point_ = _current_point;
+    prev_stamp_ = ual_pose_.header.stamp;
+    has_prev_point_ = true;
+    // Distance the UAV could cover until the next tick, or since the last one after a pause
+    double expected_motion = std::max(measured_speed_ * search_tick_period_, displacement);
+
+    return expected_motion * search_safety_factor_ + search_margin_;
+}
+
+bool Follower::isOnSearchEdge(int _pos_on_path) {
+    return (_pos_on_path == start_search_pos_on_path_ && start_search_pos_on_path_ > 0) ||
+           (_pos_on_path == end_search_pos_on_path_ && end_search_pos_on_path_ < target_path_.poses.size() - 1);
+}
+
+int Follower::searchPosOnPath(Eigen::Vector3f _current_point, double &_search_range, int _prev_normal_pos_on_path) {
+    int pos_on_path = calculatePosOnPath(_current_point, _search_range, _prev_normal_pos_on_path, target_path_);
+    // The closest point is at the border of the window, so the real one may be outside: search wider
+    int expansions = 0;
+    while (isOnSearchEdge(pos_on_path) && expansions < search_max_expansions_) {
+        _search_range = std::max(_search_range * 2.0, look_ahead_ * 1.5);
+        pos_on_path = calculatePosOnPath(_current_point, _search_range, _prev_normal_pos_on_path, target_path_);
+        expansions++;
+    }
+
+    return pos_on_path;
+}
+
+int Follower::calculatePosOnPath(Eigen::Vector3f _current_point, double _search_range, int _prev_normal_pos_on_path, const nav_msgs::Path &_path_search) {
     std::vector<double> vec_distances;
     int start_search_pos_on_path = calculateDistanceOnPath(_prev_normal_pos_on_path, -_search_range);
     int end_search_pos_on_path = calculateDistanceOnPath(_prev_normal_pos_on_path, _search_range);
-    for (int i = start_search_pos_on_path; i < end_search_pos_on_path; i++) {
+    for (int i = start_search_pos_on_path; i <= end_search_pos_on_path; i++) {
         Eigen::Vector3f target_path_point;
         target_path_point = Eigen::Vector3f(_path_search.poses.at(i).pose.position.x, _path_search.poses.at(i).pose.position.y, _path_search.poses.at(i).pose.position.z);
         vec_distances.push_back((target_path_point - _current_point).norm());
     }
     auto smallest_distance = std::min_element(vec_distances.begin(), vec_distances.end());
     int pos_on_path = smallest_distance - vec_distances.begin();
+    start_search_pos_on_path_ = start_search_pos_on_path;
+    end_search_pos_on_path_ = end_search_pos_on_path;
 
     return pos_on_path + start_search_pos_on_path;
 }
 
 int Follower::calculatePosLookAhead(int _pos_on_path) {
-    int pos_look_ahead;
+    int pos_look_ahead = _pos_on_path;
     std::vector<double> vec_distances;
     double temp_dist = 0.0;
     for (_pos_on_path; _pos_on_path < target_path_.poses.size() - 1; _pos_on_path++) {
@@ -187,6 +386,30 @@ int Follower::calculatePosLookAhead(int _pos_on_path) {
     return pos_look_ahead;
 }
 
+void Follower::buildLookAheadTable() {
+    look_ahead_table_.clear();
+    int path_size = target_path_.poses.size();
+    if (follower_mode_ != 1 || path_size < 2 || generated_times_.size() < path_size) return;
+    // Cumulative distance along the path
+    std::vector<double> arc_length(path_size, 0.0);
+    for (int i = 1; i < path_size; i++) {
+        Eigen::Vector3f p0 = Eigen::Vector3f(target_path_.poses.at(i - 1).pose.position.x, target_path_.poses.at(i - 1).pose.position.y, target_path_.poses.at(i - 1).pose.position.z);
+        Eigen::Vector3f p1 = Eigen::Vector3f(target_path_.poses.at(i).pose.position.x, target_path_.poses.at(i).pose.position.y, target_path_.poses.at(i).pose.position.z);
+        arc_length[i] = arc_length[i - 1] + (p1 - p0).norm();
+    }
+    // Same point as calculatePosLookAhead: the last one whose next point is closer than the look ahead
+    look_ahead_table_.resize(path_size);
+    int pos_look_ahead = 0;
+    for (int pos = 0; pos < path_size; pos++) {
+        double limit = arc_length[pos] + changeLookAhead(pos);
+        if (pos_look_ahead < pos) pos_look_ahead = pos;
+        while (pos_look_ahead < path_size - 2 && arc_length[pos_look_ahead + 2] < limit) pos_look_ahead++;
+        // The look ahead distance shrinks when the velocity percentage decreases
+        while (pos_look_ahead > pos && arc_length[pos_look_ahead + 1] >= limit) pos_look_ahead--;
+        look_ahead_table_[pos] = pos_look_ahead;
+    }
+}
+
 double Follower::changeLookAhead(int _pos_on_path) {
     // ROS_WARN("la: %f, max: %f, %: %f", max_vel_ * generated_times_[_pos_on_path], max_vel_, generated_times_[_pos_on_path]);
     return max_vel_ * generated_times_[_pos_on_path];
@@ -234,31 +457,27 @@ int Follower::calculateDistanceOnPath(int _prev_normal_pos_on_path, double _mete
     temp_dist = 0.0;
     if (_meters > 0) {
         if (_meters < dist_to_back) {
+            pos_equals_dist = _prev_normal_pos_on_path;
             for (int i = _prev_normal_pos_on_path; i < target_path_.poses.size() - 1; i++) {
                 Eigen::Vector3f p1 = Eigen::Vector3f(target_path_.poses.at(i).pose.position.x, target_path_.poses.at(i).pose.position.y, target_path_.poses.at(i).pose.position.z);
                 Eigen::Vector3f p2 = Eigen::Vector3f(target_path_.poses.at(i + 1).pose.position.x, target_path_.poses.at(i + 1).pose.position.y, target_path_.poses.at(i + 1).pose.position.z);
                 temp_dist = temp_dist + (p2 - p1).norm();
-                if (temp_dist < _meters) {
-                    pos_equals_dist = i;
-                } else {
-                    i = target_path_.poses.size();
-                }
+                // First pose at or beyond the distance, so the window always holds the neighbours of the previous one
+                pos_equals_dist = i + 1;
+                if (temp_dist >= _meters) i = target_path_.poses.size();
             }
         } else {
             pos_equals_dist = target_path_.poses.size() - 1;
         }
     } else {
-        if (_meters < dist_to_front) {
-            pos_equals_dist = 0;
+        if (fabs(_meters) < dist_to_front) {
+            pos_equals_dist = _prev_normal_pos_on_path;
             for (int i = _prev_normal_pos_on_path; i >= 1; i--) {
                 Eigen::Vector3f p1 = Eigen::Vector3f(target_path_.poses.at(i).pose.position.x, target_path_.poses.at(i).pose.position.y, target_path_.poses.at(i).pose.position.z);
                 Eigen::Vector3f p0 = Eigen::Vector3f(target_path_.poses.at(i - 1).pose.position.x, target_path_.poses.at(i - 1).pose.position.y, target_path_.poses.at(i - 1).pose.position.z);
                 temp_dist = temp_dist + (p1 - p0).norm();
-                if (temp_dist < fabs(_meters / 2)) {
-                    pos_equals_dist = i;
-                } else {
-                    i = 0;
-                }
+                pos_equals_dist = i - 1;
+                if (temp_dist >= fabs(_meters / 2)) i = 0;
             }
         } else {
             pos_equals_dist = 0;
@@ -280,8 +499,21 @@ void Follower::prepareDebug(double _search_range, int _normal_pos_on_path, int _
     point_search_normal_end_.point = target_path_.poses.at(end_search_pos_on_path).pose.position;
 }
 
+void Follower::pubDiagnostics() {
+    upat_follower::FollowerDiagnostics diagnostics;
+    diagnostics.header.stamp = ros::Time::now();
+    diagnostics.header.frame_id = target_path_.header.frame_id;
+    instrumentation_.fillMsg(diagnostics);
+    pub_diagnostics_.publish(diagnostics);
+    instrumentation_.reset();
+}
+
 void Follower::pubMsgs() {
-    pub_output_velocity_.publish(out_velocity_);
+    UPAT_TRACE_SCOPE("Follower::pubMsgs");
+    // Stamped when published, so rostopic delay on set_velocity measures the hop to UAL communication
+    out_velocity_.header.stamp = ros::Time::now();
+    // Shared pointer so subscribers in the same nodelet manager get it without serialization
+    pub_output_velocity_.publish(boost::make_shared<geometry_msgs::TwistStamped>(out_velocity_));
     if (debug_) {
         pub_point_look_ahead_.publish(point_look_ahead_);
         pub_point_normal_.publish(point_normal_);
@@ -291,6 +523,7 @@ void Follower::pubMsgs() {
 }
 
 geometry_msgs::TwistStamped Follower::getVelocity() {
+    UPAT_TRACE_SCOPE("Follower::getVelocity");
     if (target_path_.poses.size() > 1) {
         Eigen::Vector3f current_point, target_path0_point;
         current_point = Eigen::Vector3f(ual_pose_.pose.position.x, ual_pose_.pose.position.y, ual_pose_.pose.position.z);
@@ -299,27 +532,44 @@ geometry_msgs::TwistStamped Follower::getVelocity() {
             flag_run_ = true;
         }
         if (flag_run_) {
-            int pos_look_ahead;
+            if (diagnostics_) instrumentation_.startTick();
+            int pos_look_ahead, normal_pos_on_path;
             if (follower_mode_ == 1) {
-                double search_range_vel = look_ahead_ * 1.5;
-                int normal_vel_on_path = calculatePosOnPath(current_point, search_range_vel, prev_normal_vel_on_path_, target_path_);
-                prev_normal_vel_on_path_ = normal_vel_on_path;
-                look_ahead_ = changeLookAhead(normal_vel_on_path) /* 0.4 */;
-                pos_look_ahead = calculatePosLookAhead(normal_vel_on_path);
+                double search_range_vel = calculateSearchRange(current_point);
+                int normal_vel_on_path = searchPosOnPath(current_point, search_range_vel, prev_normal_vel_on_path_);
+                if (diagnostics_) instrumentation_.endStage(Instrumentation::stage_search_);
+                prev_normal_vel_on_path_ = normal_pos_on_path = normal_vel_on_path;
+                pos_look_ahead = getPosLookAhead(normal_vel_on_path);
+                if (diagnostics_) instrumentation_.endStage(Instrumentation::stage_look_ahead_);
                 out_velocity_ = calculateVelocity(current_point, pos_look_ahead, normal_vel_on_path);
+                if (diagnostics_) instrumentation_.endStage(Instrumentation::stage_velocity_);
                 if (debug_) {
                     prepareDebug(search_range_vel, normal_vel_on_path, pos_look_ahead, prev_normal_vel_on_path_);
                 }
             } else {
-                double search_range_normal_pos = look_ahead_ * 1.5;
-                int normal_pos_on_path = calculatePosOnPath(current_point, search_range_normal_pos, prev_normal_pos_on_path_, target_path_);
+                double search_range_normal_pos = calculateSearchRange(current_point);
+                normal_pos_on_path = searchPosOnPath(current_point, search_range_normal_pos, prev_normal_pos_on_path_);
+                if (diagnostics_) instrumentation_.endStage(Instrumentation::stage_search_);
                 prev_normal_pos_on_path_ = normal_pos_on_path;
                 pos_look_ahead = calculatePosLookAhead(normal_pos_on_path);
+                if (diagnostics_) instrumentation_.endStage(Instrumentation::stage_look_ahead_);
                 out_velocity_ = calculateVelocity(current_point, pos_look_ahead);
+                if (diagnostics_) instrumentation_.endStage(Instrumentation::stage_velocity_);
                 if (debug_) {
                     prepareDebug(search_range_normal_pos, normal_pos_on_path, pos_look_ahead, prev_normal_pos_on_path_);
                 }
             }
+            if (diagnostics_) {
+                instrumentation_.endTick();
+                instrumentation_.addSearchWindow(start_search_pos_on_path_, end_search_pos_on_path_, normal_pos_on_path, target_path_.poses.size());
+                if (prev_pos_look_ahead_ >= 0 && prev_pos_look_ahead_ < target_path_.poses.size()) {
+                    Eigen::Vector3f p_look_ahead = Eigen::Vector3f(target_path_.poses.at(pos_look_ahead).pose.position.x, target_path_.poses.at(pos_look_ahead).pose.position.y, target_path_.poses.at(pos_look_ahead).pose.position.z);
+                    Eigen::Vector3f p_prev_look_ahead = Eigen::Vector3f(target_path_.poses.at(prev_pos_look_ahead_).pose.position.x, target_path_.poses.at(prev_pos_look_ahead_).pose.position.y, target_path_.poses.at(prev_pos_look_ahead_).pose.position.z);
+                    instrumentation_.addLookAhead((p_look_ahead - p_prev_look_ahead).norm(), look_ahead_);
+                }
+                prev_pos_look_ahead_ = pos_look_ahead;
+                if (instrumentation_.isDue(1.0 / diagnostics_rate_)) pubDiagnostics();
+            }
         }
     }
     return out_velocity_;
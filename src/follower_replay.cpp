@@ -0,0 +1,170 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ros/ros.h>
+#include <upat_follower/cli.h>
+#include <upat_follower/follower.h>
+#include <upat_follower/mission_io.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Replay a recorded flight through the Follower class without roscore, Gazebo or PX4:
+// $ rosrun upat_follower follower_replay --mission config/cubic.csv --flight data/log/robot2019/la_0-4_spd_1/current_path_linear_interp.csv --generator_mode 0 --output commands.csv
+// Every recorded pose is fed to updatePose and getVelocity as fast as possible. The commanded velocities and the time
+// spent in each tick are written to --output, and compared with a previous output if --reference is given.
+
+struct Command {
+    double x, y, z, vx, vy, vz;
+    int64_t tick_ns;
+};
+
+std::vector<Command> readCommands(std::string _file_name) {
+    std::vector<Command> commands;
+    std::vector<double> values;
+    upat_follower::readCsv(_file_name, 7, values);
+    commands.resize(values.size() / 7);
+    for (size_t i = 0; i < commands.size(); i++) {
+        const double *row = &values[7 * i];
+        commands[i] = Command{row[0], row[1], row[2], row[3], row[4], row[5], static_cast<int64_t>(row[6])};
+    }
+
+    return commands;
+}
+
+std::vector<Command> replay(const nav_msgs::Path &_mission, const std::vector<double> &_times, const nav_msgs::Path &_flight, std::map<std::string, std::string> &_args) {
+    upat_follower::Follower follower(1);
+    if (_args["trajectory"] == "true") {
+        follower.prepareTrajectory(_mission, _times);
+    } else {
+        follower.preparePath(_mission, std::atoi(_args["generator_mode"].c_str()), std::atof(_args["look_ahead"].c_str()), std::atof(_args["cruising_speed"].c_str()));
+    }
+    double rate = std::atof(_args["rate"].c_str());
+    std::vector<Command> commands(_flight.poses.size());
+    for (int i = 0; i < _flight.poses.size(); i++) {
+        geometry_msgs::PoseStamped pose = _flight.poses.at(i);
+        pose.header.stamp = ros::Time(i / rate);
+        auto begin = std::chrono::steady_clock::now();
+        follower.updatePose(pose);
+        geometry_msgs::TwistStamped velocity = follower.getVelocity();
+        auto end = std::chrono::steady_clock::now();
+        commands[i].x = pose.pose.position.x;
+        commands[i].y = pose.pose.position.y;
+        commands[i].z = pose.pose.position.z;
+        commands[i].vx = velocity.twist.linear.x;
+        commands[i].vy = velocity.twist.linear.y;
+        commands[i].vz = velocity.twist.linear.z;
+        commands[i].tick_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    }
+
+    return commands;
+}
+
+int main(int _argc, char **_argv) {
+    // No master is needed: nothing is advertised and rosout is disabled
+    ros::init(_argc, _argv, "follower_replay", ros::init_options::AnonymousName | ros::init_options::NoRosout | ros::init_options::NoSigintHandler);
+
+    std::map<std::string, std::string> args;
+    args["trajectory"] = "false";
+    args["times"] = "";
+    args["generator_mode"] = "0";
+    args["look_ahead"] = "0.4";
+    args["cruising_speed"] = "1.0";
+    args["rate"] = "30";
+    args["repeat"] = "1";
+    args["tolerance"] = "0.0001";
+    upat_follower::parseArgs(_argc, _argv, args);
+    if (args["mission"].empty() || args["flight"].empty()) {
+        std::cerr << "Usage: follower_replay --mission <waypoints.csv> --flight <current_path.csv> [--trajectory true --times <times.csv>]" << std::endl
+                  << "       [--generator_mode 0|1|2] [--look_ahead m] [--cruising_speed m/s] [--rate Hz] [--repeat n]" << std::endl
+                  << "       [--output <commands.csv>] [--reference <commands.csv>] [--tolerance m/s]" << std::endl;
+        return 2;
+    }
+
+    nav_msgs::Path mission = upat_follower::csvToPath(args["mission"]);
+    nav_msgs::Path flight = upat_follower::csvToPath(args["flight"]);
+    std::vector<double> times;
+    if (!args["times"].empty()) times = upat_follower::csvToVector(args["times"]);
+    if (mission.poses.size() < 2 || flight.poses.empty()) {
+        std::cerr << "Mission needs two waypoints and flight one pose at least" << std::endl;
+        return 2;
+    }
+    if (args["trajectory"] == "true" && times.size() != mission.poses.size()) {
+        std::cerr << "Trajectory needs one time per waypoint" << std::endl;
+        return 2;
+    }
+
+    // Every repetition starts from a fresh follower, so all of them must produce the same commands
+    std::vector<Command> commands;
+    std::vector<int64_t> ticks_ns;
+    int repeat = std::max(1, std::atoi(args["repeat"].c_str()));
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) {
+        commands = replay(mission, times, flight, args);
+        for (int i = 0; i < commands.size(); i++) ticks_ns.push_back(commands[i].tick_ns);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::sort(ticks_ns.begin(), ticks_ns.end());
+    std::cout << std::fixed << std::setprecision(3)
+              << "Ticks: " << ticks_ns.size() << ", ticks/s: " << ticks_ns.size() / elapsed
+              << ", tick p50: " << ticks_ns[ticks_ns.size() / 2] / 1000.0 << " us"
+              << ", p99: " << ticks_ns[ticks_ns.size() * 99 / 100] / 1000.0 << " us"
+              << ", max: " << ticks_ns.back() / 1000.0 << " us" << std::endl;
+
+    if (!args["output"].empty()) {
+        std::ofstream csv_output(args["output"]);
+        csv_output << std::setprecision(17);
+        for (int i = 0; i < commands.size(); i++) {
+            csv_output << commands[i].x << ", " << commands[i].y << ", " << commands[i].z << ", "
+                       << commands[i].vx << ", " << commands[i].vy << ", " << commands[i].vz << ", " << commands[i].tick_ns << std::endl;
+        }
+    }
+
+    if (!args["reference"].empty()) {
+        std::vector<Command> reference = readCommands(args["reference"]);
+        double tolerance = std::atof(args["tolerance"].c_str());
+        if (reference.size() != commands.size()) {
+            std::cerr << "Reference has " << reference.size() << " ticks, replay has " << commands.size() << std::endl;
+            return 1;
+        }
+        int mismatches = 0;
+        for (int i = 0; i < commands.size(); i++) {
+            if (fabs(reference[i].vx - commands[i].vx) > tolerance || fabs(reference[i].vy - commands[i].vy) > tolerance || fabs(reference[i].vz - commands[i].vz) > tolerance) {
+                if (mismatches < 10) {
+                    std::cerr << "Tick " << i << ": expected (" << reference[i].vx << ", " << reference[i].vy << ", " << reference[i].vz
+                              << "), got (" << commands[i].vx << ", " << commands[i].vy << ", " << commands[i].vz << ")" << std::endl;
+                }
+                mismatches++;
+            }
+        }
+        if (mismatches > 0) {
+            std::cerr << mismatches << " of " << commands.size() << " commands differ from the reference" << std::endl;
+            return 1;
+        }
+        std::cout << "All " << commands.size() << " commands match the reference" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ros/ros.h>
+#include <upat_follower/cli.h>
+#include <upat_follower/follower.h>
+#include <upat_follower/generator.h>
+#include <upat_follower/mission_io.h>
+#include <upat_follower/simulator.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Fly a mission in closed loop with a kinematic UAV instead of UAL, PX4 and Gazebo:
+// $ rosrun upat_follower follower_simulator --mission config/cubic.csv --generator_mode 2 --wind 0.05 --missions 1000 --output normal_dist_cubic_spline.csv
+// The output has the same layout as the normal_dist_*.csv files of Visualization::saveMissionData.
+
+int main(int _argc, char **_argv) {
+    // No master is needed: nothing is advertised and rosout is disabled
+    ros::init(_argc, _argv, "follower_simulator", ros::init_options::AnonymousName | ros::init_options::NoRosout | ros::init_options::NoSigintHandler);
+
+    std::map<std::string, std::string> args;
+    args["trajectory"] = "false";
+    args["generator_mode"] = "0";
+    args["look_ahead"] = "0.4";
+    args["cruising_speed"] = "1.0";
+    args["lag"] = "0.3";
+    args["max_acceleration"] = "3.0";
+    args["wind"] = "0.0";
+    args["seed"] = "0";
+    args["rate"] = "30";
+    args["missions"] = "1";
+    upat_follower::parseArgs(_argc, _argv, args);
+    if (args["mission"].empty()) {
+        std::cerr << "Usage: follower_simulator --mission <waypoints.csv> [--trajectory true --times <times.csv>] [--generator_mode 0|1|2]" << std::endl
+                  << "       [--look_ahead m] [--cruising_speed m/s] [--lag s] [--max_acceleration m/s^2] [--wind m/s] [--seed n]" << std::endl
+                  << "       [--rate Hz] [--missions n] [--output <normal_dist.csv>]" << std::endl;
+        return 2;
+    }
+
+    nav_msgs::Path init_path = upat_follower::csvToPath(args["mission"]);
+    if (init_path.poses.size() < 2) {
+        std::cerr << "Mission needs two waypoints at least" << std::endl;
+        return 2;
+    }
+    std::vector<double> times;
+    if (args["trajectory"] == "true") {
+        times = upat_follower::csvToVector(args["times"]);
+        if (times.size() != init_path.poses.size()) {
+            std::cerr << "Trajectory needs one time per waypoint" << std::endl;
+            return 2;
+        }
+    }
+    // Generate once, every mission starts from a copy of the prepared follower
+    upat_follower::Follower prepared_follower(1);
+    nav_msgs::Path target_path;
+    if (args["trajectory"] == "true") {
+        target_path = prepared_follower.prepareTrajectory(init_path, times);
+    } else {
+        target_path = prepared_follower.preparePath(init_path, std::atoi(args["generator_mode"].c_str()), std::atof(args["look_ahead"].c_str()), std::atof(args["cruising_speed"].c_str()));
+    }
+    // Same reference as Visualization::saveMissionData
+    upat_follower::Generator generator(2.0, 3.0, 1.0, 0);
+    nav_msgs::Path reference_path = generator.generatePath(init_path, 0);
+
+    upat_follower::Simulator simulator(std::atof(args["lag"].c_str()), std::atof(args["max_acceleration"].c_str()), std::atof(args["wind"].c_str()), std::atoi(args["seed"].c_str()));
+    simulator.rate_ = std::atof(args["rate"].c_str());
+    int missions = std::max(1, std::atoi(args["missions"].c_str()));
+    int completed = 0;
+    double sum_mean = 0.0, sum_time = 0.0, max_distance = 0.0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < missions; i++) {
+        upat_follower::Follower follower = prepared_follower;
+        if (simulator.runMission(follower, target_path, reference_path)) completed++;
+        sum_mean += simulator.mean_normal_distance_;
+        sum_time += simulator.mission_time_;
+        max_distance = std::max(max_distance, simulator.max_normal_distance_);
+        if (i == 0 && !args["output"].empty()) {
+            std::ofstream csv_normal_distances(args["output"]);
+            simulator.saveNormalDistances(csv_normal_distances);
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << std::fixed << std::setprecision(5)
+              << "Missions: " << missions << " (" << completed << " completed), missions/s: " << missions / elapsed << std::endl
+              << "Mean normal distance: " << sum_mean / missions << " m, max: " << max_distance << " m, mean mission time: " << sum_time / missions << " s" << std::endl;
+
+    return completed == missions ? 0 : 1;
+}
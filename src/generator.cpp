@@ -18,42 +18,77 @@
 //----------------------------------------------------------------------------------------------------------------------
 
 #include <upat_follower/generator.h>
+#include <unistd.h>
 
 namespace upat_follower {
 
-Generator::Generator() : nh_(), pnh_("~") {
+namespace {
+
+// Workspace of the overloads without one, each thread reuses its own
+GeneratorWorkspace &threadWorkspace() {
+    static thread_local GeneratorWorkspace workspace;
+    return workspace;
+}
+
+}  // namespace
+
+Generator::Generator() : Generator(ros::NodeHandle(), ros::NodeHandle("~")) {
+}
+
+Generator::Generator(ros::NodeHandle _nh, ros::NodeHandle _pnh) : nh_(_nh), pnh_(_pnh) {
     double vxy, vz_up, vz_dn;
     // Parameters
     pnh_.param<double>("vxy", vxy, 2.0);
     pnh_.param<double>("vz_up", vz_up, 3.0);
     pnh_.param<double>("vz_dn", vz_dn, 1.0);
+    pnh_.param<int>("shared_path_segments", shared_path_segments_, 4);
+    pnh_.param<double>("action_feedback_rate", action_feedback_rate_, 10.0);
+    bool trace = false;
+    std::string trace_file;
+    pnh_.param<bool>("trace", trace, false);
+    pnh_.param<std::string>("trace_file", trace_file, "");
+    if (trace) enableTracing(trace_file);
+    // Client to get parameters from mavros and required default values, set before the services can be called
+    get_param_client_ = nh_.serviceClient<mavros_msgs::ParamGet>("mavros/param/get");
+    setMaxVelocities(vxy, vz_up, vz_dn);
     // Services
     server_generate_path_ = nh_.advertiseService("/upat_follower/generator/generate_path", &Generator::generatePathCb, this);
     server_generate_trajectory_ = nh_.advertiseService("/upat_follower/generator/generate_trajectory", &Generator::generateTrajectoryCb, this);
-    // Client to get parameters from mavros and required default values
-    get_param_client_ = nh_.serviceClient<mavros_msgs::ParamGet>("mavros/param/get");
-    mavros_params_["MPC_XY_VEL_MAX"] = vxy;
-    mavros_params_["MPC_Z_VEL_MAX_UP"] = vz_up;
-    mavros_params_["MPC_Z_VEL_MAX_DN"] = vz_dn;
+    server_generate_path_flat_ = nh_.advertiseService("/upat_follower/generator/generate_path_flat", &Generator::generatePathFlatCb, this);
+    server_generate_trajectory_flat_ = nh_.advertiseService("/upat_follower/generator/generate_trajectory_flat", &Generator::generateTrajectoryFlatCb, this);
+    server_generate_path_shared_ = nh_.advertiseService("/upat_follower/generator/generate_path_shared", &Generator::generatePathSharedCb, this);
+    server_generate_trajectory_shared_ = nh_.advertiseService("/upat_follower/generator/generate_trajectory_shared", &Generator::generateTrajectorySharedCb, this);
+    // Actions
+    generate_trajectory_action_.reset(new actionlib::SimpleActionServer<upat_follower::GenerateTrajectoryAction>(
+        nh_, "/upat_follower/generator/generate_trajectory_action", boost::bind(&Generator::generateTrajectoryActionCb, this, _1), false));
+    generate_trajectory_action_->start();
 }
 
 Generator::Generator(double _vxy, double _vz_up, double _vz_dn, bool _debug) {
     debug_ = _debug;
     get_param_client_ = nh_.serviceClient<mavros_msgs::ParamGet>("mavros/param/get");
-    mavros_params_["MPC_XY_VEL_MAX"] = _vxy;
-    mavros_params_["MPC_Z_VEL_MAX_UP"] = _vz_up;
-    mavros_params_["MPC_Z_VEL_MAX_DN"] = _vz_dn;
+    setMaxVelocities(_vxy, _vz_up, _vz_dn);
 }
 
 Generator::~Generator() {
+    // The action server joins its thread, stop a running fit first
+    stop_generation_ = true;
+    generate_trajectory_action_.reset();
+    for (int i = 0; i < shared_paths_.size(); i++) removeSharedPathCache(shared_paths_[i]);
+}
+
+void Generator::setMaxVelocities(double _vxy, double _vz_up, double _vz_dn) {
+    std::lock_guard<std::mutex> lock(params_mutex_);
+    mavros_params_["MPC_XY_VEL_MAX"] = _vxy;
+    mavros_params_["MPC_Z_VEL_MAX_UP"] = _vz_up;
+    mavros_params_["MPC_Z_VEL_MAX_DN"] = _vz_dn;
 }
 
-double Generator::checkSmallestMaxVel() {
+double Generator::checkSmallestMaxVel() const {
     double mpc_xy_vel_max = updateParam("MPC_XY_VEL_MAX");
     double mpc_z_vel_max_up = updateParam("MPC_Z_VEL_MAX_UP");
     double mpc_z_vel_max_dn = updateParam("MPC_Z_VEL_MAX_DN");
     double min_max_vel;
-    mpc_z_vel_max_dn = mpc_z_vel_max_dn;
     std::vector<double> velocities;
     velocities.push_back(mpc_xy_vel_max);
     velocities.push_back(mpc_z_vel_max_up);
@@ -64,10 +99,13 @@ double Generator::checkSmallestMaxVel() {
     return min_max_vel;
 }
 
-double Generator::updateParam(const std::string &_param_id) {
+double Generator::updateParam(const std::string &_param_id) const {
+    // The service call blocks, so only reading and writing the values shared by concurrent generations is locked
     mavros_msgs::ParamGet get_param_service;
     get_param_service.request.param_id = _param_id;
-    if (get_param_client_.call(get_param_service) && get_param_service.response.success) {
+    bool called = get_param_client_.call(get_param_service) && get_param_service.response.success;
+    std::lock_guard<std::mutex> lock(params_mutex_);
+    if (called) {
         mavros_params_[_param_id] = get_param_service.response.value.integer ? get_param_service.response.value.integer : get_param_service.response.value.real;
         ROS_WARN_COND(debug_, "Parameter [%s] value is [%f]", get_param_service.request.param_id.c_str(), mavros_params_[_param_id]);
     } else if (mavros_params_.count(_param_id)) {
@@ -81,7 +119,7 @@ double Generator::updateParam(const std::string &_param_id) {
     return mavros_params_[_param_id];
 }
 
-int Generator::nearestNeighbourIndex(std::vector<double> &_x, double &_value) {
+int Generator::nearestNeighbourIndex(const std::vector<double> &_x, double _value) const {
     double dist = std::numeric_limits<double>::max();
     double newDist = dist;
     size_t idx = 0;
@@ -97,13 +135,13 @@ int Generator::nearestNeighbourIndex(std::vector<double> &_x, double &_value) {
     return idx;
 }
 
-std::vector<double> Generator::linealInterp1(std::vector<double> &_x, std::vector<double> &_y, std::vector<double> &_x_new) {
-    std::vector<double> y_new;
+void Generator::linealInterp1(const std::vector<double> &_x, const std::vector<double> &_y, const std::vector<double> &_x_new, std::vector<double> &_y_new) const {
     double dx, dy, m, b;
     size_t x_max_idx = _x.size() - 1;
     size_t x_new_size = _x_new.size();
 
-    y_new.reserve(x_new_size);
+    _y_new.clear();
+    _y_new.reserve(x_new_size);
 
     for (size_t i = 0; i < x_new_size; ++i) {
         size_t idx = nearestNeighbourIndex(_x, _x_new[i]);
@@ -119,84 +157,91 @@ std::vector<double> Generator::linealInterp1(std::vector<double> &_x, std::vecto
         m = dy / dx;
         b = _y[idx] - _x[idx] * m;
 
-        y_new.push_back(_x_new[i] * m + b);
+        _y_new.push_back(_x_new[i] * m + b);
     }
-
-    return y_new;
 }
 
-nav_msgs::Path Generator::generatePath(nav_msgs::Path _init_path, int _generator_mode) {
-    std::vector<double> list_pose_x, list_pose_y, list_pose_z;
+void Generator::loadWaypoints(const nav_msgs::Path &_init_path, GeneratorWorkspace &_workspace) const {
+    _workspace.list_x.clear();
+    _workspace.list_y.clear();
+    _workspace.list_z.clear();
     for (int i = 0; i < _init_path.poses.size(); i++) {
-        list_pose_x.push_back(_init_path.poses.at(i).pose.position.x);
-        list_pose_y.push_back(_init_path.poses.at(i).pose.position.y);
-        list_pose_z.push_back(_init_path.poses.at(i).pose.position.z);
+        _workspace.list_x.push_back(_init_path.poses.at(i).pose.position.x);
+        _workspace.list_y.push_back(_init_path.poses.at(i).pose.position.y);
+        _workspace.list_z.push_back(_init_path.poses.at(i).pose.position.z);
     }
-    list_pose_x.push_back(list_pose_x.back());
-    list_pose_y.push_back(list_pose_y.back());
-    list_pose_z.push_back(list_pose_z.back());
+    _workspace.list_x.push_back(_workspace.list_x.back());
+    _workspace.list_y.push_back(_workspace.list_y.back());
+    _workspace.list_z.push_back(_workspace.list_z.back());
+}
+
+GeneratorResult Generator::generatePath(const nav_msgs::Path &_init_path, int _generator_mode, GeneratorWorkspace &_workspace) const {
+    UPAT_TRACE_SCOPE("Generator::generatePath");
+    GeneratorResult result;
+    if (_init_path.poses.empty()) return result;
+    loadWaypoints(_init_path, _workspace);
+    const std::vector<double> &list_pose_x = _workspace.list_x, &list_pose_y = _workspace.list_y, &list_pose_z = _workspace.list_z;
     int total_distance = 0;
     switch (_generator_mode) {
         case 0:
-            mode_ = mode_interp1_;
             for (int i = 0; i < _init_path.poses.size() - 1; i++) {
                 Eigen::Vector3f point_1, point_2;
                 point_1 = Eigen::Vector3f(list_pose_x[i], list_pose_y[i], list_pose_z[i]);
                 point_2 = Eigen::Vector3f(list_pose_x[i + 1], list_pose_y[i + 1], list_pose_z[i + 1]);
                 total_distance = total_distance + (point_2 - point_1).norm();
             }
-            interp1_final_size_ = total_distance / 0.02;
-            out_path_ = pathManagement(list_pose_x, list_pose_y, list_pose_z);
+            result.generated_path = pathManagement(mode_interp1_, total_distance / 0.02, _workspace);
             break;
         case 1:
-            mode_ = mode_cubic_spline_loyal_;
-            out_path_ = pathManagement(list_pose_x, list_pose_y, list_pose_z);
+            result.generated_path = pathManagement(mode_cubic_spline_loyal_, 0, _workspace);
             break;
         case 2:
-            mode_ = mode_cubic_spline_;
-            out_path_ = pathManagement(list_pose_x, list_pose_y, list_pose_z);
+            result.generated_path = pathManagement(mode_cubic_spline_, 0, _workspace);
             break;
     }
-    out_path_.header.frame_id = _init_path.header.frame_id;
+    result.generated_path.header.frame_id = _init_path.header.frame_id;
 
-    return out_path_;
+    return result;
 }
 
-nav_msgs::Path Generator::generateTrajectory(nav_msgs::Path _init_path, std::vector<double> _times) {
-    std::vector<double> list_pose_x, list_pose_y, list_pose_z;
-    for (int i = 0; i < _init_path.poses.size(); i++) {
-        list_pose_x.push_back(_init_path.poses.at(i).pose.position.x);
-        list_pose_y.push_back(_init_path.poses.at(i).pose.position.y);
-        list_pose_z.push_back(_init_path.poses.at(i).pose.position.z);
-    }
-    list_pose_x.push_back(list_pose_x.back());
-    list_pose_y.push_back(list_pose_y.back());
-    list_pose_z.push_back(list_pose_z.back());
-    if (_init_path.poses.size() - 1 == _times.size()) {
-        mode_ = mode_trajectory_;
-        size_vec_percentage_ = _times.size();
-        out_path_ = createTrajectory(list_pose_x, list_pose_y, list_pose_z, list_pose_x.size(), _times);
-        mode_ = mode_interp1_;
-        interp1_final_size_ = out_path_.poses.size();
-        generated_path_vel_percentage_ = pathManagement(list_pose_x, list_pose_y, list_pose_z);
+GeneratorResult Generator::generateTrajectory(const nav_msgs::Path &_init_path, const std::vector<double> &_times, GeneratorWorkspace &_workspace, const ProgressCallback &_progress) const {
+    UPAT_TRACE_SCOPE("Generator::generateTrajectory");
+    GeneratorResult result;
+    if (!_init_path.poses.empty() && _init_path.poses.size() - 1 == _times.size()) {
+        loadWaypoints(_init_path, _workspace);
+        double smallest_max_vel = 1.0;
+        result.generated_path = createTrajectory(_times.size(), smallest_max_vel, _progress, _workspace);
+        if (result.generated_path.poses.empty()) {
+            ROS_WARN("Generator -> Trajectory generation cancelled");
+            return result;
+        }
+        result.generated_path_vel_percentage = pathManagement(mode_interp1_, result.generated_path.poses.size(), _workspace);
         for (int i = 0; i < _times.size(); i++) {
             int j = 0;
-            for (j = 0; j < generated_path_vel_percentage_.poses.size() / (_times.size() + 1); j++) {
-                generated_times_.push_back(_times[i]);
+            for (j = 0; j < result.generated_path_vel_percentage.poses.size() / (_times.size() + 1); j++) {
+                result.generated_times.push_back(_times[i]);
             }
         }
         // TODO: Why do we still need this?
-        while (out_path_.poses.size() > generated_times_.size()) {
-            generated_times_.push_back(_times.back());
+        while (result.generated_path.poses.size() > result.generated_times.size()) {
+            result.generated_times.push_back(_times.back());
         }
-        ROS_WARN_COND(debug_, "Generator -> Path sizes -> spline: %zd, maxVel: %zd, init: %zd", out_path_.poses.size(), generated_times_.size(), _init_path.poses.size());
-        max_velocity_ = abs(smallest_max_vel_);
+        ROS_WARN_COND(debug_, "Generator -> Path sizes -> spline: %zd, maxVel: %zd, init: %zd", result.generated_path.poses.size(), result.generated_times.size(), _init_path.poses.size());
+        result.max_velocity = abs(smallest_max_vel);
     } else {
         ROS_ERROR("Time intervals size (%zd) should has one less element than init path size (%zd)", _times.size(), _init_path.poses.size());
     }
-    out_path_.header.frame_id = _init_path.header.frame_id;
+    result.generated_path.header.frame_id = _init_path.header.frame_id;
+
+    return result;
+}
 
-    return out_path_;
+nav_msgs::Path Generator::generatePath(const nav_msgs::Path &_init_path, int _generator_mode) const {
+    return generatePath(_init_path, _generator_mode, threadWorkspace()).generated_path;
+}
+
+GeneratorResult Generator::generateTrajectory(const nav_msgs::Path &_init_path, const std::vector<double> &_times, const ProgressCallback &_progress) const {
+    return generateTrajectory(_init_path, _times, threadWorkspace(), _progress);
 }
 
 bool Generator::generatePathCb(upat_follower::GeneratePath::Request &_req_path,
@@ -212,21 +257,133 @@ bool Generator::generateTrajectoryCb(upat_follower::GenerateTrajectory::Request
     for (int i = 0; i < _req_trajectory.times.size(); i++) {
         vec_times.push_back(_req_trajectory.times.at(i).data);
     }
-    _res_trajectory.generated_path = generateTrajectory(_req_trajectory.init_path, vec_times);
-    _res_trajectory.generated_path_vel_percentage = generated_path_vel_percentage_;
-    _res_trajectory.max_velocity.data = max_velocity_;
+    GeneratorResult result = generateTrajectory(_req_trajectory.init_path, vec_times);
+    _res_trajectory.generated_path = result.generated_path;
+    _res_trajectory.generated_path_vel_percentage = result.generated_path_vel_percentage;
+    _res_trajectory.max_velocity.data = result.max_velocity;
     std_msgs::Float32 temp_generated_times;
-    for (int i = 0; i < generated_times_.size(); i++) {
-        temp_generated_times.data = generated_times_.at(i);
+    for (int i = 0; i < result.generated_times.size(); i++) {
+        temp_generated_times.data = result.generated_times.at(i);
         _res_trajectory.generated_times.push_back(temp_generated_times);
     }
 
     return true;
 }
 
-std::vector<double> Generator::interpWaypointList(std::vector<double> _list_pose_axis, int _amount_of_points) {
-    std::vector<double> aux_axis;
-    std::vector<double> new_aux_axis;
+bool Generator::generatePathFlatCb(upat_follower::GeneratePathFlat::Request &_req_path,
+                                   upat_follower::GeneratePathFlat::Response &_res_path) {
+    _res_path.generated_path = toFlatPath(generatePath(toPath(_req_path.init_path), _req_path.generator_mode));
+
+    return true;
+}
+
+bool Generator::generateTrajectoryFlatCb(upat_follower::GenerateTrajectoryFlat::Request &_req_trajectory,
+                                         upat_follower::GenerateTrajectoryFlat::Response &_res_trajectory) {
+    std::vector<double> vec_times(_req_trajectory.times.begin(), _req_trajectory.times.end());
+    GeneratorResult result = generateTrajectory(toPath(_req_trajectory.init_path), vec_times);
+    _res_trajectory.generated_path = toFlatPath(result.generated_path);
+    _res_trajectory.generated_path_vel_percentage = toFlatPath(result.generated_path_vel_percentage);
+    _res_trajectory.max_velocity = result.max_velocity;
+    _res_trajectory.generated_times.assign(result.generated_times.begin(), result.generated_times.end());
+
+    return true;
+}
+
+bool Generator::generatePathSharedCb(upat_follower::GeneratePathShared::Request &_req_path,
+                                     upat_follower::GeneratePathShared::Response &_res_path) {
+    nav_msgs::Path init_path = toPath(_req_path.init_path);
+    PathCache cache;
+    cache.generator_mode_ = _req_path.generator_mode;
+    cache.hash_ = hashMission(init_path, std::vector<double>(), cache.generator_mode_);
+    cache.path_ = generatePath(init_path, _req_path.generator_mode);
+    _res_path.version = cache.hash_;
+    _res_path.size = cache.path_.poses.size();
+
+    return sharePath(cache, _res_path.handle);
+}
+
+bool Generator::generateTrajectorySharedCb(upat_follower::GenerateTrajectoryShared::Request &_req_trajectory,
+                                           upat_follower::GenerateTrajectoryShared::Response &_res_trajectory) {
+    nav_msgs::Path init_path = toPath(_req_trajectory.init_path);
+    std::vector<double> vec_times(_req_trajectory.times.begin(), _req_trajectory.times.end());
+    GeneratorResult result = generateTrajectory(init_path, vec_times);
+    PathCache cache;
+    cache.generator_mode_ = PathCache::trajectory_mode_;
+    cache.hash_ = hashMission(init_path, vec_times, cache.generator_mode_);
+    cache.path_ = result.generated_path;
+    cache.max_velocity_ = result.max_velocity;
+    cache.speed_.assign(result.generated_times.begin(), result.generated_times.begin() + std::min(result.generated_times.size(), cache.path_.poses.size()));
+    _res_trajectory.version = cache.hash_;
+    _res_trajectory.size = cache.path_.poses.size();
+    _res_trajectory.max_velocity = result.max_velocity;
+
+    return sharePath(cache, _res_trajectory.handle);
+}
+
+void Generator::generateTrajectoryActionCb(const upat_follower::GenerateTrajectoryGoalConstPtr &_goal) {
+    std::vector<double> vec_times(_goal->times.begin(), _goal->times.end());
+    upat_follower::GenerateTrajectoryFeedback feedback;
+    ros::WallTime last_feedback;
+    bool preempted = false;
+    // A newer goal preempts this one, the fit stops at its next iteration
+    ProgressCallback progress = [&](int _iteration, int _num_joints, double _max_vel, double _spline_max_vel) {
+        if (generate_trajectory_action_->isPreemptRequested() || stop_generation_ || !ros::ok()) {
+            preempted = true;
+            return false;
+        }
+        ros::WallTime now = ros::WallTime::now();
+        if ((now - last_feedback).toSec() >= 1.0 / action_feedback_rate_) {
+            feedback.iteration = _iteration;
+            feedback.num_joints = _num_joints;
+            feedback.max_velocity = _max_vel;
+            feedback.spline_max_velocity = _spline_max_vel;
+            generate_trajectory_action_->publishFeedback(feedback);
+            last_feedback = now;
+        }
+        return true;
+    };
+    GeneratorResult generated = generateTrajectory(_goal->init_path, vec_times, progress);
+    upat_follower::GenerateTrajectoryResult result;
+    if (preempted) {
+        generate_trajectory_action_->setPreempted(result, "Trajectory generation preempted");
+        return;
+    }
+    if (generated.generated_path.poses.empty()) {
+        generate_trajectory_action_->setAborted(result, "Trajectory could not be generated");
+        return;
+    }
+    result.generated_path = generated.generated_path;
+    result.generated_path_vel_percentage = generated.generated_path_vel_percentage;
+    result.max_velocity = generated.max_velocity;
+    result.generated_times.assign(generated.generated_times.begin(), generated.generated_times.end());
+    generate_trajectory_action_->setSucceeded(result);
+}
+
+bool Generator::sharePath(PathCache &_cache, std::string &_handle) {
+    {
+        std::lock_guard<std::mutex> lock(params_mutex_);
+        _cache.vxy_ = mavros_params_["MPC_XY_VEL_MAX"];
+        _cache.vz_up_ = mavros_params_["MPC_Z_VEL_MAX_UP"];
+        _cache.vz_dn_ = mavros_params_["MPC_Z_VEL_MAX_DN"];
+    }
+    std::lock_guard<std::mutex> lock(shared_paths_mutex_);
+    _handle = "/upat_follower_generator_" + std::to_string(getpid()) + "_" + std::to_string(shared_path_count_++);
+    if (!writeSharedPathCache(_handle, _cache)) return false;
+    // Keep the last segments, a client may not have mapped them yet
+    shared_paths_.push_back(_handle);
+    while (shared_paths_.size() > std::max(1, shared_path_segments_)) {
+        removeSharedPathCache(shared_paths_.front());
+        shared_paths_.pop_front();
+    }
+
+    return true;
+}
+
+void Generator::interpWaypointList(const std::vector<double> &_list_pose_axis, int _amount_of_points, std::vector<double> &_interp1_list, GeneratorWorkspace &_workspace) const {
+    std::vector<double> &aux_axis = _workspace.aux_axis;
+    std::vector<double> &new_aux_axis = _workspace.new_aux_axis;
+    aux_axis.clear();
+    new_aux_axis.clear();
     for (int i = 0; i < _list_pose_axis.size(); i++) {
         aux_axis.push_back(i);
     }
@@ -237,44 +394,41 @@ std::vector<double> Generator::interpWaypointList(std::vector<double> _list_pose
         new_pose = new_pose + portion;
         new_aux_axis.push_back(new_pose);
     }
-    auto interp1_path = linealInterp1(aux_axis, _list_pose_axis, new_aux_axis);
-    return interp1_path;
+    linealInterp1(aux_axis, _list_pose_axis, new_aux_axis, _interp1_list);
 }
 
-nav_msgs::Path Generator::constructPath(std::vector<double> _wps_x, std::vector<double> _wps_y, std::vector<double> _wps_z) {
-    nav_msgs::Path path_msg;
-    std::vector<geometry_msgs::PoseStamped> poses(_wps_x.size());
+void Generator::constructPath(const std::vector<double> &_wps_x, const std::vector<double> &_wps_y, const std::vector<double> &_wps_z, nav_msgs::Path &_path) const {
+    _path.poses.resize(_wps_x.size());
     for (int i = 0; i < _wps_x.size(); i++) {
-        poses.at(i).pose.position.x = _wps_x[i];
-        poses.at(i).pose.position.y = _wps_y[i];
-        poses.at(i).pose.position.z = _wps_z[i];
-        poses.at(i).pose.orientation.x = 0;
-        poses.at(i).pose.orientation.y = 0;
-        poses.at(i).pose.orientation.z = 0;
-        poses.at(i).pose.orientation.w = 1;
+        geometry_msgs::Pose &pose = _path.poses.at(i).pose;
+        pose.position.x = _wps_x[i];
+        pose.position.y = _wps_y[i];
+        pose.position.z = _wps_z[i];
+        pose.orientation.x = 0;
+        pose.orientation.y = 0;
+        pose.orientation.z = 0;
+        pose.orientation.w = 1;
     }
-    path_msg.poses = poses;
-
-    return path_msg;
 }
 
-nav_msgs::Path Generator::createPathInterp1(std::vector<double> _list_x, std::vector<double> _list_y, std::vector<double> _list_z, int _path_size, int _new_path_size) {
+nav_msgs::Path Generator::createPathInterp1(int _new_path_size, GeneratorWorkspace &_workspace) const {
     nav_msgs::Path interp1_path;
-    std::vector<double> interp1_list_x, interp1_list_y, interp1_list_z;
-    if (_path_size > 1) {
+    if (_workspace.list_x.size() > 1) {
         // Lineal interpolation
-        interp1_list_x = interpWaypointList(_list_x, _new_path_size);
-        interp1_list_y = interpWaypointList(_list_y, _new_path_size);
-        interp1_list_z = interpWaypointList(_list_z, _new_path_size);
+        interpWaypointList(_workspace.list_x, _new_path_size, _workspace.interp1_x, _workspace);
+        interpWaypointList(_workspace.list_y, _new_path_size, _workspace.interp1_y, _workspace);
+        interpWaypointList(_workspace.list_z, _new_path_size, _workspace.interp1_z, _workspace);
         // Construct path
-        interp1_path = constructPath(interp1_list_x, interp1_list_y, interp1_list_z);
+        constructPath(_workspace.interp1_x, _workspace.interp1_y, _workspace.interp1_z, interp1_path);
     }
 
     return interp1_path;
 }
 
-nav_msgs::Path Generator::createPathCubicSpline(std::vector<double> _list_x, std::vector<double> _list_y, std::vector<double> _list_z, int _path_size) {
+nav_msgs::Path Generator::createPathCubicSpline(mode_t _mode, GeneratorWorkspace &_workspace) const {
     nav_msgs::Path cubic_spline_path;
+    const std::vector<double> &_list_x = _workspace.list_x, &_list_y = _workspace.list_y, &_list_z = _workspace.list_z;
+    int _path_size = _list_x.size();
     if (_path_size > 1) {
         // Calculate total distance
         int total_distance = 0;
@@ -286,19 +440,21 @@ nav_msgs::Path Generator::createPathCubicSpline(std::vector<double> _list_x, std
         }
         // Calculate number of joints
         int num_joints = 0;
-        switch (mode_) {
+        switch (_mode) {
             case mode_cubic_spline_loyal_:
                 num_joints = (_path_size - 1) * 2;
                 break;
             case mode_cubic_spline_:
                 num_joints = _path_size - 1;
                 break;
+            default:
+                break;
         }
         // Lineal interpolation
-        std::vector<double> interp1_list_x, interp1_list_y, interp1_list_z;
-        interp1_list_x = interpWaypointList(_list_x, num_joints);
-        interp1_list_y = interpWaypointList(_list_y, num_joints);
-        interp1_list_z = interpWaypointList(_list_z, num_joints);
+        std::vector<double> &interp1_list_x = _workspace.interp1_x, &interp1_list_y = _workspace.interp1_y, &interp1_list_z = _workspace.interp1_z;
+        interpWaypointList(_list_x, num_joints, interp1_list_x, _workspace);
+        interpWaypointList(_list_y, num_joints, interp1_list_y, _workspace);
+        interpWaypointList(_list_z, num_joints, interp1_list_z, _workspace);
         // Prepare sets for each cubic spline
         ecl::Array<double> t_set(interp1_list_x.size()), x_set(interp1_list_x.size()), y_set(interp1_list_x.size()), z_set(interp1_list_x.size());
         for (int i = 0; i < interp1_list_x.size(); i++) {
@@ -314,21 +470,26 @@ nav_msgs::Path Generator::createPathCubicSpline(std::vector<double> _list_x, std
         // Change format: ecl::CubicSpline -> std::vector
         double sp_pts = total_distance;
         int _amount_of_points = (interp1_list_x.size() - 1) * sp_pts;
-        std::vector<double> spline_list_x(_amount_of_points), spline_list_y(_amount_of_points), spline_list_z(_amount_of_points);
+        std::vector<double> &spline_list_x = _workspace.spline_x, &spline_list_y = _workspace.spline_y, &spline_list_z = _workspace.spline_z;
+        spline_list_x.resize(_amount_of_points);
+        spline_list_y.resize(_amount_of_points);
+        spline_list_z.resize(_amount_of_points);
         for (int i = 0; i < _amount_of_points; i++) {
             spline_list_x[i] = spline_x(i / sp_pts);
             spline_list_y[i] = spline_y(i / sp_pts);
             spline_list_z[i] = spline_z(i / sp_pts);
         }
         // Construct path
-        cubic_spline_path = constructPath(spline_list_x, spline_list_y, spline_list_z);
+        constructPath(spline_list_x, spline_list_y, spline_list_z, cubic_spline_path);
     }
 
     return cubic_spline_path;
 }
 
-nav_msgs::Path Generator::createTrajectory(std::vector<double> _list_x, std::vector<double> _list_y, std::vector<double> _list_z, int _path_size, std::vector<double> _times) {
+nav_msgs::Path Generator::createTrajectory(int _size_vec_percentage, double &_smallest_max_vel, const ProgressCallback &_progress, GeneratorWorkspace &_workspace) const {
     nav_msgs::Path cubic_spline_path;
+    const std::vector<double> &_list_x = _workspace.list_x, &_list_y = _workspace.list_y, &_list_z = _workspace.list_z;
+    int _path_size = _list_x.size();
     if (_path_size > 1) {
         // Calculate total distance
         // TODO: Use or not use total_distance (?)
@@ -342,13 +503,15 @@ nav_msgs::Path Generator::createTrajectory(std::vector<double> _list_x, std::vec
         // Calculate number of joints
         int num_joints = _path_size;
         bool try_fit_spline = true;
-        smallest_max_vel_ = checkSmallestMaxVel();
+        _smallest_max_vel = checkSmallestMaxVel();
+        std::vector<double> &interp1_list_x = _workspace.interp1_x, &interp1_list_y = _workspace.interp1_y, &interp1_list_z = _workspace.interp1_z;
+        std::vector<double> &spline_list_x = _workspace.spline_x, &spline_list_y = _workspace.spline_y, &spline_list_z = _workspace.spline_z;
         while (try_fit_spline) {
+            UPAT_TRACE_SCOPE("Generator::createTrajectory iteration");
             // Lineal interpolation
-            std::vector<double> interp1_list_x, interp1_list_y, interp1_list_z;
-            interp1_list_x = interpWaypointList(_list_x, num_joints);
-            interp1_list_y = interpWaypointList(_list_y, num_joints);
-            interp1_list_z = interpWaypointList(_list_z, num_joints);
+            interpWaypointList(_list_x, num_joints, interp1_list_x, _workspace);
+            interpWaypointList(_list_y, num_joints, interp1_list_y, _workspace);
+            interpWaypointList(_list_z, num_joints, interp1_list_z, _workspace);
             // Prepare sets for each cubic spline
             ecl::Array<double> t_set(interp1_list_x.size()), x_set(interp1_list_x.size()), y_set(interp1_list_x.size()), z_set(interp1_list_x.size());
             for (int i = 0; i < interp1_list_x.size(); i++) {
@@ -361,28 +524,33 @@ nav_msgs::Path Generator::createTrajectory(std::vector<double> _list_x, std::vec
             ecl::CubicSpline spline_x = ecl::CubicSpline::Natural(t_set, x_set);
             ecl::CubicSpline spline_y = ecl::CubicSpline::Natural(t_set, y_set);
             ecl::CubicSpline spline_z = ecl::CubicSpline::Natural(t_set, z_set);
-            // Change format: ecl::CubicSpline -> std::vector
+            // Change format: ecl::CubicSpline -> std::vector, keeping the max and min velocity of every axis
             double sp_pts = total_distance;
             int _amount_of_points = (interp1_list_x.size() - 1) * sp_pts;
-            std::vector<double> spline_list_x(_amount_of_points), spline_list_y(_amount_of_points), spline_list_z(_amount_of_points);
-            std::vector<double> vec_check_vel;
+            spline_list_x.resize(_amount_of_points);
+            spline_list_y.resize(_amount_of_points);
+            spline_list_z.resize(_amount_of_points);
+            double spline_max_vel = -std::numeric_limits<double>::max();
+            double spline_min_vel = std::numeric_limits<double>::max();
             for (int i = 0; i < _amount_of_points; i++) {
                 spline_list_x[i] = spline_x(i / sp_pts);
                 spline_list_y[i] = spline_y(i / sp_pts);
                 spline_list_z[i] = spline_z(i / sp_pts);
-                vec_check_vel.push_back(spline_x.derivative(i / sp_pts));
-                vec_check_vel.push_back(spline_y.derivative(i / sp_pts));
-                vec_check_vel.push_back(spline_z.derivative(i / sp_pts));
+                double vel_x = spline_x.derivative(i / sp_pts);
+                double vel_y = spline_y.derivative(i / sp_pts);
+                double vel_z = spline_z.derivative(i / sp_pts);
+                spline_max_vel = std::max(spline_max_vel, std::max(vel_x, std::max(vel_y, vel_z)));
+                spline_min_vel = std::min(spline_min_vel, std::min(vel_x, std::min(vel_y, vel_z)));
+            }
+            std::div_t temp_div = std::div(spline_list_x.size(), _size_vec_percentage);
+            if (_progress && !_progress(num_joints - _path_size, num_joints, _smallest_max_vel, std::max(spline_max_vel, fabs(spline_min_vel)))) {
+                return nav_msgs::Path();
             }
-            // Check max and min velocity
-            double spline_max_vel = *std::max_element(vec_check_vel.begin(), vec_check_vel.end());
-            double spline_min_vel = *std::min_element(vec_check_vel.begin(), vec_check_vel.end());
-            std::div_t temp_div = std::div(spline_list_x.size(), size_vec_percentage_);
-            if (spline_max_vel > smallest_max_vel_ || fabs(spline_min_vel) > smallest_max_vel_ || temp_div.rem != 0) {
+            if (spline_max_vel > _smallest_max_vel || fabs(spline_min_vel) > _smallest_max_vel || temp_div.rem != 0) {
                 num_joints++;
             } else {
                 ROS_WARN_COND(debug_, "Generator -> Spline done in %d iterations! Spline max velocities: %f and %f", num_joints - _path_size, spline_max_vel, spline_min_vel);
-                cubic_spline_path = constructPath(spline_list_x, spline_list_y, spline_list_z);
+                constructPath(spline_list_x, spline_list_y, spline_list_z, cubic_spline_path);
                 try_fit_spline = false;
             }
         }
@@ -391,14 +559,16 @@ nav_msgs::Path Generator::createTrajectory(std::vector<double> _list_x, std::vec
     return cubic_spline_path;
 }
 
-nav_msgs::Path Generator::pathManagement(std::vector<double> _list_pose_x, std::vector<double> _list_pose_y, std::vector<double> _list_pose_z) {
-    switch (mode_) {
+nav_msgs::Path Generator::pathManagement(mode_t _mode, int _interp1_final_size, GeneratorWorkspace &_workspace) const {
+    switch (_mode) {
         case mode_interp1_:
-            return createPathInterp1(_list_pose_x, _list_pose_y, _list_pose_z, _list_pose_x.size(), interp1_final_size_);
+            return createPathInterp1(_interp1_final_size, _workspace);
         case mode_cubic_spline_loyal_:
-            return createPathCubicSpline(_list_pose_x, _list_pose_y, _list_pose_z, _list_pose_x.size());
+            return createPathCubicSpline(_mode, _workspace);
         case mode_cubic_spline_:
-            return createPathCubicSpline(_list_pose_x, _list_pose_y, _list_pose_z, _list_pose_x.size());
+            return createPathCubicSpline(_mode, _workspace);
+        default:
+            return nav_msgs::Path();
     }
 }
 
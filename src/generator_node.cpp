@@ -24,13 +24,12 @@ int main(int _argc, char **_argv) {
     ros::init(_argc, _argv, "generator_node");
 
     upat_follower::Generator generator;
-    int pub_rate_;
-    ros::param::param<int>("~pub_rate", pub_rate_, 30);
-    ros::Rate rate(pub_rate_);
-    while (ros::ok()) {
-        ros::spinOnce();
-        rate.sleep();
-    }
+    // Requests are served concurrently, 0 uses as many threads as cores
+    int threads;
+    ros::param::param<int>("~threads", threads, 0);
+    ros::AsyncSpinner spinner(threads);
+    spinner.start();
+    ros::waitForShutdown();
 
     return 0;
 }
\ No newline at end of file
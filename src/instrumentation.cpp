@@ -0,0 +1,137 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <upat_follower/instrumentation.h>
+#include <algorithm>
+#include <limits>
+
+namespace upat_follower {
+
+LatencyHistogram::LatencyHistogram() : counts_(bounds().size(), 0) {
+}
+
+LatencyHistogram::~LatencyHistogram() {
+}
+
+const std::vector<double> &LatencyHistogram::bounds() {
+    // Upper bound of every bucket in microseconds, the last one catches everything else
+    static const std::vector<double> bounds_us = {1.0, 2.0, 5.0, 10.0, 20.0, 50.0, 100.0, 200.0, 500.0,
+                                                  1000.0, 2000.0, 5000.0, 10000.0, std::numeric_limits<double>::infinity()};
+    return bounds_us;
+}
+
+void LatencyHistogram::add(double _us) {
+    const std::vector<double> &bounds_us = bounds();
+    int bucket = 0;
+    while (_us >= bounds_us[bucket]) bucket++;
+    counts_[bucket]++;
+    samples_++;
+    sum_us_ += _us;
+    if (_us > max_us_) max_us_ = _us;
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    samples_ = 0;
+    sum_us_ = 0.0;
+    max_us_ = 0.0;
+}
+
+double LatencyHistogram::mean() const {
+    return samples_ > 0 ? sum_us_ / samples_ : 0.0;
+}
+
+double LatencyHistogram::max() const {
+    return max_us_;
+}
+
+Instrumentation::Instrumentation() {
+    last_report_ = clock_t::now();
+}
+
+Instrumentation::~Instrumentation() {
+}
+
+void Instrumentation::startTick() {
+    tick_begin_ = stage_begin_ = clock_t::now();
+}
+
+void Instrumentation::endStage(stage_t _stage) {
+    clock_t::time_point now = clock_t::now();
+    histograms_[_stage].add(std::chrono::duration<double, std::micro>(now - stage_begin_).count());
+    stage_begin_ = now;
+}
+
+void Instrumentation::endTick() {
+    histograms_[stage_total_].add(std::chrono::duration<double, std::micro>(clock_t::now() - tick_begin_).count());
+    ticks_++;
+}
+
+void Instrumentation::addSearchWindow(int _start_search, int _end_search, int _pos_found, int _path_size) {
+    uint32_t window = _end_search >= _start_search ? _end_search - _start_search + 1 : 0;
+    if (search_windows_ == 0 || window < search_window_min_) search_window_min_ = window;
+    if (window > search_window_max_) search_window_max_ = window;
+    search_window_sum_ += window;
+    search_windows_++;
+    // The normal point is on the border of the window but the path continues beyond it
+    if ((_pos_found == _start_search && _start_search > 0) || (_pos_found == _end_search && _end_search < _path_size - 1)) {
+        window_edge_hits_++;
+    }
+}
+
+void Instrumentation::addLookAhead(double _displacement, double _look_ahead) {
+    // The look ahead point should never move further than the look ahead distance in one tick
+    if (_displacement > _look_ahead) look_ahead_jumps_++;
+}
+
+bool Instrumentation::isDue(double _period) {
+    return std::chrono::duration<double>(clock_t::now() - last_report_).count() >= _period;
+}
+
+void Instrumentation::fillMsg(upat_follower::FollowerDiagnostics &_msg) {
+    _msg.ticks = ticks_;
+    _msg.window_edge_hits = window_edge_hits_;
+    _msg.look_ahead_jumps = look_ahead_jumps_;
+    _msg.search_window_min = search_window_min_;
+    _msg.search_window_max = search_window_max_;
+    _msg.search_window_mean = search_windows_ > 0 ? (double)search_window_sum_ / search_windows_ : 0.0;
+    const std::vector<double> &bounds_us = LatencyHistogram::bounds();
+    _msg.histogram_bounds_us.assign(bounds_us.begin(), bounds_us.end());
+    _msg.search_histogram = histograms_[stage_search_].counts_;
+    _msg.look_ahead_histogram = histograms_[stage_look_ahead_].counts_;
+    _msg.velocity_histogram = histograms_[stage_velocity_].counts_;
+    _msg.total_histogram = histograms_[stage_total_].counts_;
+    _msg.search_mean_us = histograms_[stage_search_].mean();
+    _msg.look_ahead_mean_us = histograms_[stage_look_ahead_].mean();
+    _msg.velocity_mean_us = histograms_[stage_velocity_].mean();
+    _msg.total_mean_us = histograms_[stage_total_].mean();
+    _msg.total_max_us = histograms_[stage_total_].max();
+}
+
+void Instrumentation::reset() {
+    for (int i = 0; i < stage_count_; i++) histograms_[i].reset();
+    ticks_ = window_edge_hits_ = look_ahead_jumps_ = 0;
+    search_window_min_ = search_window_max_ = 0;
+    search_window_sum_ = 0;
+    search_windows_ = 0;
+    last_report_ = clock_t::now();
+}
+
+}  // namespace upat_follower
@@ -0,0 +1,202 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ros/ros.h>
+#include <upat_follower/mission_io.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace upat_follower {
+
+namespace {
+
+const double kPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline bool isSeparator(char _c) {
+    return _c == ',' || _c == ' ' || _c == '\t' || _c == '\r';
+}
+
+// Parse the number starting at _p. Plain decimals with up to 15 significant digits are converted exactly (both the
+// mantissa and the power of ten are exact doubles), anything else goes through strtod. Return the end of the number,
+// or _p if there is none.
+const char *parseDouble(const char *_p, const char *_end, double &_value) {
+    const char *p = _p;
+    bool negative = false;
+    if (p < _end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    uint64_t mantissa = 0;
+    int digits = 0, decimals = 0;
+    const char *first_digit = p;
+    while (p < _end && *p >= '0' && *p <= '9') {
+        mantissa = mantissa * 10 + (*p++ - '0');
+        if (mantissa != 0) digits++;
+    }
+    bool any_digit = p > first_digit;
+    if (p < _end && *p == '.') {
+        p++;
+        const char *first_decimal = p;
+        while (p < _end && *p >= '0' && *p <= '9') {
+            mantissa = mantissa * 10 + (*p++ - '0');
+            if (mantissa != 0) digits++;
+            decimals++;
+        }
+        any_digit = any_digit || p > first_decimal;
+    }
+    bool plain = any_digit && digits <= 15 && decimals <= 22 && (p == _end || isSeparator(*p) || *p == '\n' || *p == '#');
+    if (plain) {
+        _value = static_cast<double>(mantissa) / kPow10[decimals];
+        if (negative) _value = -_value;
+        return p;
+    }
+    // Exponents, long mantissas, inf and nan
+    char buffer[64];
+    size_t length = 0;
+    while (_p + length < _end && length < sizeof(buffer) - 1 && !isSeparator(_p[length]) && _p[length] != '\n' && _p[length] != '#') length++;
+    std::memcpy(buffer, _p, length);
+    buffer[length] = '\0';
+    char *number_end;
+    _value = std::strtod(buffer, &number_end);
+    return _p + (number_end - buffer);
+}
+
+}  // namespace
+
+bool readCsv(const std::string &_file_name, int _columns, std::vector<double> &_values) {
+    _values.clear();
+    int fd = open(_file_name.c_str(), O_RDONLY);
+    if (fd == -1) {
+        ROS_ERROR("Could not open %s", _file_name.c_str());
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1) {
+        ROS_ERROR("Could not read %s", _file_name.c_str());
+        close(fd);
+        return false;
+    }
+    size_t size = file_stat.st_size;
+    if (size == 0) {
+        close(fd);
+        return true;
+    }
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        ROS_ERROR("Could not map %s", _file_name.c_str());
+        return false;
+    }
+    const char *begin = static_cast<const char *>(data);
+    const char *end = begin + size;
+    _values.reserve(std::count(begin, end, '\n') * _columns + _columns);
+
+    bool ok = true, first_row = true;
+    int line = 0;
+    const char *p = begin;
+    while (p < end && ok) {
+        line++;
+        const char *line_end = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+        int fields = 0;
+        bool header = false;
+        while (p < line_end) {
+            while (p < line_end && isSeparator(*p)) p++;
+            if (p == line_end || *p == '#') break;
+            double value;
+            const char *number_end = parseDouble(p, line_end, value);
+            if (number_end == p || (number_end < line_end && !isSeparator(*number_end) && *number_end != '#')) {
+                // Text before the first row is a header, anywhere else it is an error
+                if (first_row && fields == 0) {
+                    header = true;
+                } else {
+                    ROS_ERROR("%s:%d: field %d is not a number", _file_name.c_str(), line, fields + 1);
+                    ok = false;
+                }
+                break;
+            }
+            if (fields < _columns) _values.push_back(value);
+            fields++;
+            p = number_end;
+        }
+        if (ok && !header && fields > 0) {
+            if (fields < _columns) {
+                ROS_ERROR("%s:%d: %d fields, expected %d", _file_name.c_str(), line, fields, _columns);
+                ok = false;
+            }
+            first_row = false;
+        }
+        p = line_end + 1;
+    }
+    munmap(data, size);
+    if (!ok) _values.clear();
+
+    return ok;
+}
+
+nav_msgs::Path csvToPath(const std::string &_file_name, const std::string &_frame_id) {
+    nav_msgs::Path out_path;
+    out_path.header.frame_id = _frame_id;
+    std::vector<double> values;
+    if (!readCsv(_file_name, 3, values)) return out_path;
+    out_path.poses.resize(values.size() / 3);
+    for (size_t i = 0; i < out_path.poses.size(); i++) {
+        out_path.poses[i].pose.position.x = values[3 * i];
+        out_path.poses[i].pose.position.y = values[3 * i + 1];
+        out_path.poses[i].pose.position.z = values[3 * i + 2];
+        out_path.poses[i].pose.orientation.w = 1;
+    }
+
+    return out_path;
+}
+
+std::vector<double> csvToVector(const std::string &_file_name) {
+    std::vector<double> out_vector;
+    readCsv(_file_name, 1, out_vector);
+
+    return out_vector;
+}
+
+bool pathToCsv(const std::string &_file_name, const nav_msgs::Path &_path, int _precision) {
+    std::string buffer;
+    buffer.reserve(_path.poses.size() * 3 * (_precision + 8));
+    char row[128];
+    for (size_t i = 0; i < _path.poses.size(); i++) {
+        const geometry_msgs::Point &position = _path.poses[i].pose.position;
+        int length = std::snprintf(row, sizeof(row), "%.*f, %.*f, %.*f\n", _precision, position.x, _precision, position.y, _precision, position.z);
+        buffer.append(row, std::min<size_t>(length, sizeof(row) - 1));
+    }
+    FILE *file = std::fopen(_file_name.c_str(), "wb");
+    if (!file) {
+        ROS_ERROR("Could not open %s", _file_name.c_str());
+        return false;
+    }
+    bool ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) ROS_ERROR("Could not write %s", _file_name.c_str());
+
+    return ok;
+}
+
+}  // namespace upat_follower
\ No newline at end of file
@@ -0,0 +1,176 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ros/ros.h>
+#include <upat_follower/mission_log.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace upat_follower {
+
+namespace {
+
+const char kMagic[8] = "UPATLOG";
+const uint32_t kVersion = 1;
+
+}  // namespace
+
+MissionLog::MissionLog(size_t _queue_capacity) : queue_(_queue_capacity) {
+    running_.store(false);
+    dropped_.store(0);
+}
+
+MissionLog::~MissionLog() {
+    close();
+}
+
+bool MissionLog::open(const std::string &_file_name, const std::string &_normal_dist_csv, const std::string &_current_path_csv, double _flush_period) {
+    close();
+    file_ = fopen(_file_name.c_str(), "wb");
+    if (!file_) {
+        ROS_ERROR("Mission log: can not open %s", _file_name.c_str());
+        return false;
+    }
+    MissionLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic_, kMagic, sizeof(header.magic_));
+    header.version_ = kVersion;
+    header.record_size_ = sizeof(MissionLogRecord);
+    strncpy(header.normal_dist_csv_, _normal_dist_csv.c_str(), sizeof(header.normal_dist_csv_) - 1);
+    strncpy(header.current_path_csv_, _current_path_csv.c_str(), sizeof(header.current_path_csv_) - 1);
+    fwrite(&header, sizeof(header), 1, file_);
+    fflush(file_);
+    flush_period_ = _flush_period;
+    dropped_.store(0);
+    running_.store(true);
+    writer_ = std::thread(&MissionLog::writerLoop, this);
+
+    return true;
+}
+
+void MissionLog::close() {
+    if (!file_) return;
+    running_.store(false);
+    if (writer_.joinable()) writer_.join();
+    fclose(file_);
+    file_ = NULL;
+    if (dropped_.load() > 0) ROS_WARN("Mission log: %lu records dropped, the queue was full", (unsigned long)dropped_.load());
+}
+
+bool MissionLog::logNormalDistance(double _time, double _generated_path, double _init_path) {
+    return log(MissionLogRecord::normal_distance_, _time, _generated_path, _init_path);
+}
+
+bool MissionLog::logCurrentPath(double _x, double _y, double _z) {
+    return log(MissionLogRecord::current_path_, _x, _y, _z);
+}
+
+bool MissionLog::log(uint32_t _type, double _a, double _b, double _c) {
+    if (!file_) return false;
+    MissionLogRecord record;
+    record.type_ = _type;
+    record.reserved_ = 0;
+    record.values_[0] = _a;
+    record.values_[1] = _b;
+    record.values_[2] = _c;
+    if (queue_.tryPush(record)) return true;
+    dropped_++;
+
+    return false;
+}
+
+void MissionLog::writerLoop() {
+    std::vector<MissionLogRecord> records;
+    records.reserve(queue_.capacity());
+    std::chrono::steady_clock::time_point last_flush = std::chrono::steady_clock::now();
+    bool running = true;
+    while (running) {
+        // Read the flag before draining, so everything pushed before close() is written
+        running = running_.load();
+        MissionLogRecord record;
+        while (records.size() < records.capacity() && queue_.tryPop(record)) records.push_back(record);
+        if (!records.empty()) {
+            fwrite(records.data(), sizeof(MissionLogRecord), records.size(), file_);
+            records.clear();
+        }
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (!running || std::chrono::duration<double>(now - last_flush).count() >= flush_period_) {
+            fflush(file_);
+            last_flush = now;
+        }
+        if (running && queue_.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+bool convertMissionLog(const std::string &_file_name, const std::string &_folder) {
+    FILE *log_file = fopen(_file_name.c_str(), "rb");
+    if (!log_file) {
+        ROS_ERROR("Mission log: can not open %s", _file_name.c_str());
+        return false;
+    }
+    MissionLogHeader header;
+    if (fread(&header, sizeof(header), 1, log_file) != 1 || memcmp(header.magic_, kMagic, sizeof(header.magic_)) != 0 ||
+        header.version_ != kVersion || header.record_size_ != sizeof(MissionLogRecord)) {
+        ROS_ERROR("Mission log: %s is not a mission log of version %u", _file_name.c_str(), kVersion);
+        fclose(log_file);
+        return false;
+    }
+    header.normal_dist_csv_[sizeof(header.normal_dist_csv_) - 1] = '\0';
+    header.current_path_csv_[sizeof(header.current_path_csv_) - 1] = '\0';
+    std::string folder = _folder;
+    if (folder.empty()) {
+        size_t slash = _file_name.find_last_of('/');
+        folder = slash == std::string::npos ? "." : _file_name.substr(0, slash);
+    }
+    FILE *csv_normal_dist = fopen((folder + "/" + header.normal_dist_csv_).c_str(), "w");
+    FILE *csv_current_path = fopen((folder + "/" + header.current_path_csv_).c_str(), "w");
+    if (!csv_normal_dist || !csv_current_path) {
+        ROS_ERROR("Mission log: can not write the CSV files in %s", folder.c_str());
+        if (csv_normal_dist) fclose(csv_normal_dist);
+        if (csv_current_path) fclose(csv_current_path);
+        fclose(log_file);
+        return false;
+    }
+    // Same text as the former std::fixed << std::setprecision(5) and default std::ostream output
+    std::vector<MissionLogRecord> records(4096);
+    size_t read_records;
+    while ((read_records = fread(records.data(), sizeof(MissionLogRecord), records.size(), log_file)) > 0) {
+        for (size_t i = 0; i < read_records; i++) {
+            const double *values = records[i].values_;
+            if (records[i].type_ == MissionLogRecord::normal_distance_) {
+                fprintf(csv_normal_dist, "%.5f,", values[0]);
+                if (!std::isnan(values[1])) fprintf(csv_normal_dist, "%.5f,", values[1]);
+                if (!std::isnan(values[2])) fprintf(csv_normal_dist, "%.5f", values[2]);
+                fputc('\n', csv_normal_dist);
+            } else if (records[i].type_ == MissionLogRecord::current_path_) {
+                fprintf(csv_current_path, "%g, %g, %g\n", values[0], values[1], values[2]);
+            }
+        }
+    }
+    fclose(csv_normal_dist);
+    fclose(csv_current_path);
+    fclose(log_file);
+
+    return true;
+}
+
+}  // namespace upat_follower
\ No newline at end of file
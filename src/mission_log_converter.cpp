@@ -0,0 +1,44 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ros/ros.h>
+#include <upat_follower/cli.h>
+#include <upat_follower/mission_log.h>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Write the CSV files of a mission log, for example after visualization_node crashed:
+// $ rosrun upat_follower mission_log_converter --input data/log/2019-05-20_10-00-00/mission.log
+// The files are written next to the log unless --output gives another folder.
+
+int main(int _argc, char **_argv) {
+    // No master is needed: nothing is advertised and rosout is disabled
+    ros::init(_argc, _argv, "mission_log_converter", ros::init_options::AnonymousName | ros::init_options::NoRosout | ros::init_options::NoSigintHandler);
+
+    std::map<std::string, std::string> args;
+    upat_follower::parseArgs(_argc, _argv, args);
+    if (args["input"].empty()) {
+        std::cerr << "Usage: mission_log_converter --input <mission.log> [--output <folder>]" << std::endl;
+        return 2;
+    }
+
+    return upat_follower::convertMissionLog(args["input"], args["output"]) ? 0 : 1;
+}
\ No newline at end of file
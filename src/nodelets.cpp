@@ -0,0 +1,112 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <upat_follower/follower.h>
+#include <upat_follower/generator.h>
+#include <upat_follower/ual_communication.h>
+#include <upat_follower/visualization.h>
+#include <boost/shared_ptr.hpp>
+
+// Nodelet versions of generator_node, follower_node, ual_communication_node and visualization_node. Loaded into the
+// same manager, topics published as shared pointers reach the other nodelets without serialization.
+
+namespace upat_follower {
+
+class GeneratorNodelet : public nodelet::Nodelet {
+   public:
+    virtual void onInit() {
+        // Requests are served by the manager worker threads, the generator is reentrant
+        generator_.reset(new Generator(getMTNodeHandle(), getMTPrivateNodeHandle()));
+    }
+
+   private:
+    boost::shared_ptr<Generator> generator_;
+};
+
+class FollowerNodelet : public nodelet::Nodelet {
+   public:
+    virtual void onInit() {
+        double pub_rate;
+        getPrivateNodeHandle().param<double>("pub_rate", pub_rate, 30.0);
+        follower_.reset(new Follower(getNodeHandle(), getPrivateNodeHandle()));
+        timer_ = getNodeHandle().createTimer(ros::Duration(1.0 / pub_rate), &FollowerNodelet::timerCallback, this);
+    }
+
+   private:
+    void timerCallback(const ros::TimerEvent &_event) {
+        follower_->getVelocity();
+        follower_->pubMsgs();
+    }
+    boost::shared_ptr<Follower> follower_;
+    ros::Timer timer_;
+};
+
+class UALCommunicationNodelet : public nodelet::Nodelet {
+   public:
+    virtual void onInit() {
+        double pub_rate;
+        getPrivateNodeHandle().param<double>("pub_rate", pub_rate, 30.0);
+        ual_communication_.reset(new UALCommunication(getNodeHandle(), getPrivateNodeHandle()));
+        timer_ = getNodeHandle().createTimer(ros::Duration(1.0 / pub_rate), &UALCommunicationNodelet::timerCallback, this);
+    }
+
+   private:
+    void timerCallback(const ros::TimerEvent &_event) {
+        ual_communication_->runMission();
+        ual_communication_->callVisualization();
+    }
+    boost::shared_ptr<UALCommunication> ual_communication_;
+    ros::Timer timer_;
+};
+
+class VisualizationNodelet : public nodelet::Nodelet {
+   public:
+    virtual ~VisualizationNodelet() {
+        if (visualization_ && visualization_->save_experiment) visualization_->closeExperimentFiles();
+    }
+
+    virtual void onInit() {
+        bool save_experiment_data, trajectory;
+        int generator_mode;
+        getPrivateNodeHandle().param<bool>("save_experiment_data", save_experiment_data, false);
+        getPrivateNodeHandle().param<bool>("trajectory", trajectory, true);
+        getPrivateNodeHandle().param<int>("generator_mode", generator_mode, 0);
+        visualization_.reset(new Visualization(getNodeHandle(), getPrivateNodeHandle()));
+        visualization_->save_experiment = save_experiment_data;
+        if (visualization_->save_experiment) visualization_->openExperimentFiles(trajectory, generator_mode);
+        timer_ = getNodeHandle().createTimer(ros::Duration(1.0 / 50.0), &VisualizationNodelet::timerCallback, this);
+    }
+
+   private:
+    void timerCallback(const ros::TimerEvent &_event) {
+        visualization_->update();
+    }
+    boost::shared_ptr<Visualization> visualization_;
+    ros::Timer timer_;
+};
+
+}  // namespace upat_follower
+
+PLUGINLIB_EXPORT_CLASS(upat_follower::GeneratorNodelet, nodelet::Nodelet)
+PLUGINLIB_EXPORT_CLASS(upat_follower::FollowerNodelet, nodelet::Nodelet)
+PLUGINLIB_EXPORT_CLASS(upat_follower::UALCommunicationNodelet, nodelet::Nodelet)
+PLUGINLIB_EXPORT_CLASS(upat_follower::VisualizationNodelet, nodelet::Nodelet)
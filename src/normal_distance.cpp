@@ -0,0 +1,95 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <upat_follower/normal_distance.h>
+
+namespace upat_follower {
+
+NormalDistance::NormalDistance(double _search_range) : search_range_(_search_range) {
+}
+
+NormalDistance::~NormalDistance() {
+}
+
+void NormalDistance::reset() {
+    normal_pos_on_path_ = 0;
+    normal_distance_ = 0.0;
+}
+
+double NormalDistance::calculate(Eigen::Vector3f _current_point, const nav_msgs::Path &_path_search) {
+    if (normal_pos_on_path_ >= _path_search.poses.size()) normal_pos_on_path_ = 0;
+    std::vector<double> vec_distances;
+    int start_search_pos_on_path = calculateDistanceOnPath(normal_pos_on_path_, -search_range_, _path_search);
+    int end_search_pos_on_path = calculateDistanceOnPath(normal_pos_on_path_, search_range_, _path_search);
+    for (int i = start_search_pos_on_path; i <= end_search_pos_on_path; i++) {
+        Eigen::Vector3f target_path_point;
+        target_path_point = Eigen::Vector3f(_path_search.poses.at(i).pose.position.x, _path_search.poses.at(i).pose.position.y, _path_search.poses.at(i).pose.position.z);
+        vec_distances.push_back((target_path_point - _current_point).norm());
+    }
+    if (vec_distances.empty()) return normal_distance_;
+    auto smallest_distance = std::min_element(vec_distances.begin(), vec_distances.end());
+    normal_pos_on_path_ = smallest_distance - vec_distances.begin() + start_search_pos_on_path;
+    normal_distance_ = *smallest_distance;
+
+    return normal_distance_;
+}
+
+int NormalDistance::calculateDistanceOnPath(int _prev_normal_pos_on_path, double _meters, const nav_msgs::Path &_path_search) {
+    int pos_equals_dist;
+    double dist_to_front, dist_to_back, temp_dist;
+    Eigen::Vector3f p_prev = Eigen::Vector3f(_path_search.poses.at(_prev_normal_pos_on_path).pose.position.x, _path_search.poses.at(_prev_normal_pos_on_path).pose.position.y, _path_search.poses.at(_prev_normal_pos_on_path).pose.position.z);
+    Eigen::Vector3f p_front = Eigen::Vector3f(_path_search.poses.front().pose.position.x, _path_search.poses.front().pose.position.y, _path_search.poses.front().pose.position.z);
+    Eigen::Vector3f p_back = Eigen::Vector3f(_path_search.poses.back().pose.position.x, _path_search.poses.back().pose.position.y, _path_search.poses.back().pose.position.z);
+    dist_to_front = (p_prev - p_front).norm();
+    dist_to_back = (p_prev - p_back).norm();
+    temp_dist = 0.0;
+    if (_meters > 0) {
+        if (_meters < dist_to_back) {
+            pos_equals_dist = _prev_normal_pos_on_path;
+            for (int i = _prev_normal_pos_on_path; i < _path_search.poses.size() - 1; i++) {
+                Eigen::Vector3f p1 = Eigen::Vector3f(_path_search.poses.at(i).pose.position.x, _path_search.poses.at(i).pose.position.y, _path_search.poses.at(i).pose.position.z);
+                Eigen::Vector3f p2 = Eigen::Vector3f(_path_search.poses.at(i + 1).pose.position.x, _path_search.poses.at(i + 1).pose.position.y, _path_search.poses.at(i + 1).pose.position.z);
+                temp_dist = temp_dist + (p2 - p1).norm();
+                // First pose at or beyond the distance, so the window always holds the neighbours of the previous one
+                pos_equals_dist = i + 1;
+                if (temp_dist >= _meters) i = _path_search.poses.size();
+            }
+        } else {
+            pos_equals_dist = _path_search.poses.size() - 1;
+        }
+    } else {
+        if (fabs(_meters) < dist_to_front) {
+            pos_equals_dist = _prev_normal_pos_on_path;
+            for (int i = _prev_normal_pos_on_path; i >= 1; i--) {
+                Eigen::Vector3f p1 = Eigen::Vector3f(_path_search.poses.at(i).pose.position.x, _path_search.poses.at(i).pose.position.y, _path_search.poses.at(i).pose.position.z);
+                Eigen::Vector3f p0 = Eigen::Vector3f(_path_search.poses.at(i - 1).pose.position.x, _path_search.poses.at(i - 1).pose.position.y, _path_search.poses.at(i - 1).pose.position.z);
+                temp_dist = temp_dist + (p1 - p0).norm();
+                pos_equals_dist = i - 1;
+                if (temp_dist >= fabs(_meters / 2)) i = 0;
+            }
+        } else {
+            pos_equals_dist = 0;
+        }
+    }
+
+    return pos_equals_dist;
+}
+
+}  // namespace upat_follower
@@ -0,0 +1,48 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <upat_follower/parallel.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace upat_follower {
+
+void parallelFor(int _count, std::function<void(int)> _task, int _threads) {
+    if (_threads <= 0) _threads = std::max(1u, std::thread::hardware_concurrency());
+    _threads = std::min(_threads, _count);
+    std::atomic<int> next_index(0);
+    auto worker = [&]() {
+        for (int i = next_index++; i < _count; i = next_index++) {
+            _task(i);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < _threads; i++) {
+        workers.push_back(std::thread(worker));
+    }
+    worker();
+    for (int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+}  // namespace upat_follower
@@ -0,0 +1,204 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ros/ros.h>
+#include <upat_follower/cli.h>
+#include <upat_follower/follower.h>
+#include <upat_follower/generator.h>
+#include <upat_follower/mission_io.h>
+#include <upat_follower/parallel.h>
+#include <upat_follower/simulator.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+
+// Evaluate every combination of look ahead, cruising speed, generator mode and velocity limits in closed loop with
+// the headless simulator, spread over all cores:
+// $ rosrun upat_follower parameter_sweep --mission config/cubic.csv --times config/times.csv --generator_mode 0,1,2,3 --look_ahead 0.4,0.8,1.2 --cruising_speed 0.5,1,1.5 --output sweep.csv
+// Generator mode 3 is the trajectory, which ignores look ahead and cruising speed.
+
+struct Generation {
+    int generator_mode;
+    double vxy, vz_up, vz_dn;
+    nav_msgs::Path target_path;
+    std::shared_ptr<upat_follower::Follower> follower;
+};
+
+struct Run {
+    int generation;
+    double look_ahead, cruising_speed;
+    bool completed;
+    double mean_normal_distance, rms_normal_distance, max_normal_distance, mission_time;
+};
+
+std::vector<double> listToVector(std::string _list) {
+    std::replace(_list.begin(), _list.end(), ',', ' ');
+    std::stringstream slist(_list);
+    std::vector<double> out_vector;
+    double value;
+    while (slist >> value) {
+        out_vector.push_back(value);
+    }
+
+    return out_vector;
+}
+
+int main(int _argc, char **_argv) {
+    // No master is needed: nothing is advertised and rosout is disabled
+    ros::init(_argc, _argv, "parameter_sweep", ros::init_options::AnonymousName | ros::init_options::NoRosout | ros::init_options::NoSigintHandler);
+
+    std::map<std::string, std::string> args;
+    args["generator_mode"] = "0,1,2";
+    args["look_ahead"] = "0.4,0.8,1.2";
+    args["cruising_speed"] = "0.5,1.0,1.5";
+    args["vxy"] = "2.0";
+    args["vz_up"] = "3.0";
+    args["vz_dn"] = "1.0";
+    args["lag"] = "0.3";
+    args["max_acceleration"] = "3.0";
+    args["wind"] = "0.0";
+    args["seed"] = "0";
+    args["rate"] = "30";
+    args["threads"] = "0";
+    upat_follower::parseArgs(_argc, _argv, args);
+    if (args["mission"].empty()) {
+        std::cerr << "Usage: parameter_sweep --mission <waypoints.csv> [--times <times.csv>] [--generator_mode 0,1,2,3] [--look_ahead list]" << std::endl
+                  << "       [--cruising_speed list] [--vxy list] [--vz_up list] [--vz_dn list] [--lag s] [--max_acceleration m/s^2]" << std::endl
+                  << "       [--wind m/s] [--seed n] [--rate Hz] [--threads n] [--output <summary.csv>]" << std::endl;
+        return 2;
+    }
+
+    nav_msgs::Path init_path = upat_follower::csvToPath(args["mission"]);
+    std::vector<double> times = upat_follower::csvToVector(args["times"]);
+    std::vector<double> generator_modes = listToVector(args["generator_mode"]);
+    std::vector<double> look_aheads = listToVector(args["look_ahead"]);
+    std::vector<double> cruising_speeds = listToVector(args["cruising_speed"]);
+    std::vector<double> vxys = listToVector(args["vxy"]);
+    std::vector<double> vz_ups = listToVector(args["vz_up"]);
+    std::vector<double> vz_dns = listToVector(args["vz_dn"]);
+    if (init_path.poses.size() < 2) {
+        std::cerr << "Mission needs two waypoints at least" << std::endl;
+        return 2;
+    }
+    if (std::count(generator_modes.begin(), generator_modes.end(), 3.0) > 0 && times.size() != init_path.poses.size()) {
+        std::cerr << "Trajectory (generator mode 3) needs one time per waypoint" << std::endl;
+        return 2;
+    }
+
+    // Look ahead and cruising speed do not change the generated path: generate once per mode and velocity limits
+    std::vector<Generation> generations;
+    for (int m = 0; m < generator_modes.size(); m++) {
+        for (int i = 0; i < vxys.size(); i++) {
+            for (int j = 0; j < vz_ups.size(); j++) {
+                for (int k = 0; k < vz_dns.size(); k++) {
+                    Generation generation;
+                    generation.generator_mode = generator_modes[m];
+                    generation.vxy = vxys[i];
+                    generation.vz_up = vz_ups[j];
+                    generation.vz_dn = vz_dns[k];
+                    generations.push_back(generation);
+                }
+            }
+        }
+    }
+    int threads = std::atoi(args["threads"].c_str());
+    auto begin = std::chrono::steady_clock::now();
+    upat_follower::parallelFor(generations.size(), [&](int _i) {
+        Generation &generation = generations[_i];
+        generation.follower = std::make_shared<upat_follower::Follower>(1);
+        generation.follower->setMaxVelocities(generation.vxy, generation.vz_up, generation.vz_dn);
+        if (generation.generator_mode == 3) {
+            generation.target_path = generation.follower->prepareTrajectory(init_path, times);
+        } else {
+            generation.target_path = generation.follower->preparePath(init_path, generation.generator_mode);
+        }
+    }, threads);
+    // Same reference as Visualization::saveMissionData
+    upat_follower::Generator generator(2.0, 3.0, 1.0, 0);
+    nav_msgs::Path reference_path = generator.generatePath(init_path, 0);
+
+    std::vector<Run> runs;
+    for (int g = 0; g < generations.size(); g++) {
+        Run run;
+        run.generation = g;
+        if (generations[g].generator_mode == 3) {
+            run.look_ahead = run.cruising_speed = 0.0;
+            runs.push_back(run);
+            continue;
+        }
+        for (int i = 0; i < look_aheads.size(); i++) {
+            for (int j = 0; j < cruising_speeds.size(); j++) {
+                run.look_ahead = look_aheads[i];
+                run.cruising_speed = cruising_speeds[j];
+                runs.push_back(run);
+            }
+        }
+    }
+    upat_follower::parallelFor(runs.size(), [&](int _i) {
+        Run &run = runs[_i];
+        const Generation &generation = generations[run.generation];
+        upat_follower::Follower follower = *generation.follower;
+        if (generation.generator_mode != 3) follower.loadPath(generation.target_path, run.look_ahead, run.cruising_speed);
+        upat_follower::Simulator simulator(std::atof(args["lag"].c_str()), std::atof(args["max_acceleration"].c_str()), std::atof(args["wind"].c_str()), std::atoi(args["seed"].c_str()));
+        simulator.rate_ = std::atof(args["rate"].c_str());
+        run.completed = simulator.runMission(follower, generation.target_path, reference_path);
+        run.mean_normal_distance = simulator.mean_normal_distance_;
+        run.rms_normal_distance = simulator.rms_normal_distance_;
+        run.max_normal_distance = simulator.max_normal_distance_;
+        run.mission_time = simulator.mission_time_;
+    }, threads);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::stringstream summary;
+    summary << std::fixed << std::setprecision(5)
+            << "generator_mode,look_ahead,cruising_speed,vxy,vz_up,vz_dn,completed,mean_normal_dist,rms_normal_dist,max_normal_dist,mission_time" << std::endl;
+    int best = -1;
+    for (int i = 0; i < runs.size(); i++) {
+        const Run &run = runs[i];
+        const Generation &generation = generations[run.generation];
+        summary << generation.generator_mode << ",";
+        if (generation.generator_mode == 3) {
+            summary << "-,-,";
+        } else {
+            summary << run.look_ahead << "," << run.cruising_speed << ",";
+        }
+        summary << generation.vxy << "," << generation.vz_up << "," << generation.vz_dn << "," << run.completed << ","
+                << run.mean_normal_distance << "," << run.rms_normal_distance << "," << run.max_normal_distance << "," << run.mission_time << std::endl;
+        if (run.completed && (best < 0 || run.mean_normal_distance < runs[best].mean_normal_distance)) best = i;
+    }
+    std::cout << summary.str();
+    if (!args["output"].empty()) {
+        std::ofstream csv_summary(args["output"]);
+        csv_summary << summary.str();
+    }
+    std::cout << runs.size() << " runs in " << elapsed << " s" << std::endl;
+    if (best >= 0) {
+        std::cout << "Lowest mean normal distance: row " << best + 1 << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ros/ros.h>
+#include <upat_follower/path_cache.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace upat_follower {
+
+namespace {
+
+const char kMagic[8] = {'U', 'P', 'A', 'T', 'P', 'A', 'T', 'H'};
+const uint32_t kVersion = 1;
+
+int columnCount(uint32_t _flags) {
+    return 3 + (_flags & PathCacheHeader::flag_arc_length_ ? 1 : 0) + (_flags & PathCacheHeader::flag_speed_ ? 1 : 0);
+}
+
+void hashBytes(uint64_t &_hash, const void *_data, size_t _size) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(_data);
+    for (size_t i = 0; i < _size; i++) {
+        _hash ^= bytes[i];
+        _hash *= 1099511628211ULL;
+    }
+}
+
+}  // namespace
+
+const int PathCache::trajectory_mode_;
+
+MappedPathCache::MappedPathCache() {
+}
+
+MappedPathCache::~MappedPathCache() {
+    close();
+}
+
+bool MappedPathCache::open(const std::string &_file_name) {
+    close();
+    int fd = ::open(_file_name.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+
+    return map(fd, _file_name);
+}
+
+bool MappedPathCache::openShared(const std::string &_name) {
+    close();
+    int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+    if (fd == -1) {
+        ROS_ERROR("Shared path %s not found", _name.c_str());
+        return false;
+    }
+
+    return map(fd, _name);
+}
+
+bool MappedPathCache::map(int _fd, const std::string &_file_name) {
+    struct stat file_stat;
+    if (fstat(_fd, &file_stat) == -1 || static_cast<size_t>(file_stat.st_size) < sizeof(PathCacheHeader)) {
+        ROS_ERROR("%s is not a path cache", _file_name.c_str());
+        ::close(_fd);
+        return false;
+    }
+    data_size_ = file_stat.st_size;
+    data_ = mmap(nullptr, data_size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, _fd, 0);
+    ::close(_fd);
+    if (data_ == MAP_FAILED) {
+        ROS_ERROR("Could not map %s", _file_name.c_str());
+        data_ = nullptr;
+        return false;
+    }
+    header_ = static_cast<const PathCacheHeader *>(data_);
+    bool has_magic = std::memcmp(header_->magic_, kMagic, sizeof(kMagic)) == 0;
+    // Pairs with the release in writeSharedPathCache, the rest is written before the magic
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!has_magic || header_->version_ != kVersion) {
+        ROS_ERROR("%s is not a path cache of version %u", _file_name.c_str(), kVersion);
+        close();
+        return false;
+    }
+    if (data_size_ != sizeof(PathCacheHeader) + columnCount(header_->flags_) * header_->size_ * sizeof(double)) {
+        ROS_ERROR("%s is truncated", _file_name.c_str());
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedPathCache::close() {
+    if (data_) munmap(data_, data_size_);
+    data_ = nullptr;
+    data_size_ = 0;
+    header_ = nullptr;
+}
+
+const double *MappedPathCache::speed() const {
+    if (!(header_->flags_ & PathCacheHeader::flag_speed_)) return nullptr;
+    return column(header_->flags_ & PathCacheHeader::flag_arc_length_ ? 4 : 3);
+}
+
+const double *MappedPathCache::column(int _index) const {
+    const double *columns = reinterpret_cast<const double *>(static_cast<const char *>(data_) + sizeof(PathCacheHeader));
+    return columns + _index * header_->size_;
+}
+
+uint64_t hashMission(const nav_msgs::Path &_init_path, const std::vector<double> &_times, int _generator_mode) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < _init_path.poses.size(); i++) {
+        const geometry_msgs::Point &position = _init_path.poses.at(i).pose.position;
+        double point[3] = {position.x, position.y, position.z};
+        hashBytes(hash, point, sizeof(point));
+    }
+    if (!_times.empty()) hashBytes(hash, _times.data(), _times.size() * sizeof(double));
+    hashBytes(hash, &_generator_mode, sizeof(_generator_mode));
+
+    return hash;
+}
+
+namespace {
+
+// Header and columns of a path cache, false if it can not be stored
+bool buildPathCache(const PathCache &_cache, PathCacheHeader &_header, std::vector<double> &_columns) {
+    const std::vector<geometry_msgs::PoseStamped> &poses = _cache.path_.poses;
+    size_t size = poses.size();
+    std::memset(&_header, 0, sizeof(_header));
+    std::memcpy(_header.magic_, kMagic, sizeof(kMagic));
+    _header.version_ = kVersion;
+    _header.flags_ = PathCacheHeader::flag_arc_length_;
+    if (_cache.speed_.size() == size && size > 0) _header.flags_ |= PathCacheHeader::flag_speed_;
+    _header.size_ = size;
+    _header.generator_mode_ = _cache.generator_mode_;
+    _header.vxy_ = _cache.vxy_;
+    _header.vz_up_ = _cache.vz_up_;
+    _header.vz_dn_ = _cache.vz_dn_;
+    _header.max_velocity_ = _cache.max_velocity_;
+    _header.hash_ = _cache.hash_;
+    if (_cache.path_.header.frame_id.size() >= sizeof(_header.frame_id_)) {
+        ROS_ERROR("Frame id %s is too long for a path cache", _cache.path_.header.frame_id.c_str());
+        return false;
+    }
+    std::strncpy(_header.frame_id_, _cache.path_.header.frame_id.c_str(), sizeof(_header.frame_id_) - 1);
+
+    _columns.assign(columnCount(_header.flags_) * size, 0.0);
+    for (size_t i = 0; i < size; i++) {
+        _columns[i] = poses[i].pose.position.x;
+        _columns[size + i] = poses[i].pose.position.y;
+        _columns[2 * size + i] = poses[i].pose.position.z;
+    }
+    double *arc_length = &_columns[0] + 3 * size;
+    for (size_t i = 0; i < size; i++) {
+        if (_cache.arc_length_.size() == size) {
+            arc_length[i] = _cache.arc_length_[i];
+        } else if (i == 0) {
+            arc_length[i] = 0.0;
+        } else {
+            double dx = _columns[i] - _columns[i - 1];
+            double dy = _columns[size + i] - _columns[size + i - 1];
+            double dz = _columns[2 * size + i] - _columns[2 * size + i - 1];
+            arc_length[i] = arc_length[i - 1] + std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+    }
+    if (_header.flags_ & PathCacheHeader::flag_speed_) std::copy(_cache.speed_.begin(), _cache.speed_.end(), arc_length + size);
+
+    return true;
+}
+
+void readPathCache(const MappedPathCache &_mapped, PathCache &_cache) {
+    const PathCacheHeader &header = _mapped.header();
+    size_t size = header.size_;
+    _cache.generator_mode_ = header.generator_mode_;
+    _cache.vxy_ = header.vxy_;
+    _cache.vz_up_ = header.vz_up_;
+    _cache.vz_dn_ = header.vz_dn_;
+    _cache.max_velocity_ = header.max_velocity_;
+    _cache.hash_ = header.hash_;
+    _cache.path_.header.frame_id = std::string(header.frame_id_, strnlen(header.frame_id_, sizeof(header.frame_id_)));
+    _cache.path_.poses.resize(size);
+    const double *x = _mapped.x(), *y = _mapped.y(), *z = _mapped.z();
+    for (size_t i = 0; i < size; i++) {
+        geometry_msgs::PoseStamped &pose = _cache.path_.poses[i];
+        pose.pose.position.x = x[i];
+        pose.pose.position.y = y[i];
+        pose.pose.position.z = z[i];
+        pose.pose.orientation.w = 1;
+    }
+    _cache.arc_length_.clear();
+    if (_mapped.arcLength()) _cache.arc_length_.assign(_mapped.arcLength(), _mapped.arcLength() + size);
+    _cache.speed_.clear();
+    if (_mapped.speed()) _cache.speed_.assign(_mapped.speed(), _mapped.speed() + size);
+}
+
+}  // namespace
+
+bool savePathCache(const std::string &_file_name, const PathCache &_cache) {
+    PathCacheHeader header;
+    std::vector<double> columns;
+    if (!buildPathCache(_cache, header, columns)) return false;
+    std::ofstream file(_file_name, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!columns.empty()) file.write(reinterpret_cast<const char *>(columns.data()), columns.size() * sizeof(double));
+    if (!file.good()) {
+        ROS_ERROR("Could not write %s", _file_name.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool loadPathCache(const std::string &_file_name, PathCache &_cache) {
+    MappedPathCache mapped;
+    if (!mapped.open(_file_name)) return false;
+    readPathCache(mapped, _cache);
+
+    return true;
+}
+
+bool writeSharedPathCache(const std::string &_name, const PathCache &_cache) {
+    PathCacheHeader header;
+    std::vector<double> columns;
+    if (!buildPathCache(_cache, header, columns)) return false;
+    size_t size = sizeof(header) + columns.size() * sizeof(double);
+    // Handles are never reused, an existing segment is an error. The segment is visible as soon as it is created, so
+    // the magic is written last: until then a reader finds a zeroed one and rejects it as not a path cache
+    int fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1 || ftruncate(fd, size) == -1) {
+        ROS_ERROR("Could not create shared path %s", _name.c_str());
+        if (fd != -1) {
+            ::close(fd);
+            shm_unlink(_name.c_str());
+        }
+        return false;
+    }
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        ROS_ERROR("Could not map shared path %s", _name.c_str());
+        shm_unlink(_name.c_str());
+        return false;
+    }
+    if (!columns.empty()) std::memcpy(static_cast<char *>(data) + sizeof(header), columns.data(), columns.size() * sizeof(double));
+    std::memcpy(static_cast<char *>(data) + sizeof(header.magic_), reinterpret_cast<const char *>(&header) + sizeof(header.magic_), sizeof(header) - sizeof(header.magic_));
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(data, header.magic_, sizeof(header.magic_));
+    munmap(data, size);
+
+    return true;
+}
+
+bool loadSharedPathCache(const std::string &_name, PathCache &_cache) {
+    MappedPathCache mapped;
+    if (!mapped.openShared(_name)) return false;
+    readPathCache(mapped, _cache);
+
+    return true;
+}
+
+void removeSharedPathCache(const std::string &_name) {
+    shm_unlink(_name.c_str());
+}
+
+}  // namespace upat_follower
\ No newline at end of file
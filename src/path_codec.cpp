@@ -0,0 +1,260 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <upat_follower/path_codec.h>
+#include <cmath>
+#include <cstring>
+
+namespace upat_follower {
+
+namespace {
+
+const char kMagic[4] = {'U', 'P', 'C', 'Z'};
+const uint32_t kVersion = 1;
+const size_t kBlockSize = 128;
+
+struct PathCodecHeader {
+    char magic_[4];
+    uint32_t version_;
+    uint64_t size_;
+    double resolution_;
+};
+
+inline uint64_t zigzag(uint64_t _value) {
+    return (_value << 1) ^ (0 - (_value >> 63));
+}
+
+inline uint64_t unzigzag(uint64_t _value) {
+    return (_value >> 1) ^ (0 - (_value & 1));
+}
+
+void putVarint(uint64_t _value, std::vector<uint8_t> &_data) {
+    while (_value >= 0x80) {
+        _data.push_back(static_cast<uint8_t>(_value) | 0x80);
+        _value >>= 7;
+    }
+    _data.push_back(static_cast<uint8_t>(_value));
+}
+
+bool getVarint(const uint8_t *_data, size_t _data_size, size_t &_pos, uint64_t &_value) {
+    _value = 0;
+    for (int shift = 0; shift < 64 && _pos < _data_size; shift += 7) {
+        uint8_t byte = _data[_pos++];
+        _value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+int bitWidth(uint64_t _value) {
+    int width = 0;
+    while (_value) {
+        width++;
+        _value >>= 1;
+    }
+    return width;
+}
+
+// Bits [_bit, _bit + _width) of a little endian bit stream, one byte at a time
+uint64_t getBits(const uint8_t *_data, size_t _bit, int _width) {
+    uint64_t value = 0;
+    for (int i = 0; i < _width; i++, _bit++) value |= static_cast<uint64_t>((_data[_bit >> 3] >> (_bit & 7)) & 1) << i;
+    return value;
+}
+
+inline uint64_t load64(const uint8_t *_data) {
+    uint64_t value;
+    std::memcpy(&value, _data, sizeof(value));  // Little endian hosts only, as the path cache
+    return value;
+}
+
+}  // namespace
+
+void encodeColumn(const double *_values, size_t _size, double _resolution, std::vector<uint8_t> &_data) {
+    if (_size == 0) return;
+    // Unsigned arithmetic wraps around, decoding undoes it exactly
+    std::vector<uint64_t> quantised(_size);
+    for (size_t i = 0; i < _size; i++) quantised[i] = static_cast<uint64_t>(std::llround(_values[i] / _resolution));
+    putVarint(zigzag(quantised[0]), _data);
+    if (_size == 1) return;
+    putVarint(zigzag(quantised[1] - quantised[0]), _data);
+    std::vector<uint64_t> block;
+    block.reserve(kBlockSize);
+    for (size_t begin = 2; begin < _size; begin += kBlockSize) {
+        size_t end = std::min(_size, begin + kBlockSize);
+        block.clear();
+        uint64_t all_bits = 0;
+        for (size_t i = begin; i < end; i++) {
+            uint64_t second_delta = (quantised[i] - quantised[i - 1]) - (quantised[i - 1] - quantised[i - 2]);
+            block.push_back(zigzag(second_delta));
+            all_bits |= block.back();
+        }
+        int width = bitWidth(all_bits);
+        _data.push_back(static_cast<uint8_t>(width));
+        size_t first_byte = _data.size();
+        _data.resize(first_byte + (block.size() * width + 7) / 8, 0);
+        uint8_t *bytes = &_data[first_byte];
+        size_t bit = 0;
+        for (size_t i = 0; i < block.size(); i++) {
+            for (int b = 0; b < width; b += 8 - ((bit + b) & 7)) {
+                size_t position = bit + b;
+                bytes[position >> 3] |= static_cast<uint8_t>((block[i] >> b) << (position & 7));
+            }
+            bit += width;
+        }
+    }
+}
+
+size_t decodeColumn(const uint8_t *_data, size_t _data_size, size_t _size, double _resolution, double *_values) {
+    if (_size == 0) return 0;
+    size_t pos = 0;
+    uint64_t quantised, delta;
+    if (!getVarint(_data, _data_size, pos, quantised)) return 0;
+    quantised = unzigzag(quantised);
+    _values[0] = static_cast<int64_t>(quantised) * _resolution;
+    if (_size == 1) return pos;
+    if (!getVarint(_data, _data_size, pos, delta)) return 0;
+    delta = unzigzag(delta);
+    quantised += delta;
+    _values[1] = static_cast<int64_t>(quantised) * _resolution;
+    for (size_t begin = 2; begin < _size; begin += kBlockSize) {
+        size_t count = std::min(_size - begin, kBlockSize);
+        if (pos >= _data_size) return 0;
+        int width = _data[pos++];
+        size_t block_bytes = (count * width + 7) / 8;
+        if (width > 64 || pos + block_bytes > _data_size) return 0;
+        const uint8_t *bytes = _data + pos;
+        double *values = _values + begin;
+        if (width == 0) {
+            // Constant first delta, as straight lines sampled evenly
+            for (size_t i = 0; i < count; i++) {
+                quantised += delta;
+                values[i] = static_cast<int64_t>(quantised) * _resolution;
+            }
+        } else if (width <= 56) {
+            // Read 8 bytes at every value, the last ones of the data one byte at a time
+            uint64_t mask = (1ULL << width) - 1;
+            size_t fast_count = block_bytes + pos + 8 <= _data_size ? count : (block_bytes >= 8 ? ((block_bytes - 8) * 8) / width : 0);
+            size_t bit = 0;
+            for (size_t i = 0; i < count; i++, bit += width) {
+                uint64_t value = i < fast_count ? (load64(bytes + (bit >> 3)) >> (bit & 7)) & mask : getBits(bytes, bit, width);
+                delta += unzigzag(value);
+                quantised += delta;
+                values[i] = static_cast<int64_t>(quantised) * _resolution;
+            }
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                delta += unzigzag(getBits(bytes, i * width, width));
+                quantised += delta;
+                values[i] = static_cast<int64_t>(quantised) * _resolution;
+            }
+        }
+        pos += block_bytes;
+    }
+
+    return pos;
+}
+
+std::vector<uint8_t> encodePath(const nav_msgs::Path &_path, double _resolution) {
+    size_t size = _path.poses.size();
+    PathCodecHeader header;
+    std::memcpy(header.magic_, kMagic, sizeof(kMagic));
+    header.version_ = kVersion;
+    header.size_ = size;
+    header.resolution_ = _resolution;
+    std::vector<uint8_t> data(reinterpret_cast<const uint8_t *>(&header), reinterpret_cast<const uint8_t *>(&header) + sizeof(header));
+    std::vector<double> column(size);
+    for (int axis = 0; axis < 3; axis++) {
+        for (size_t i = 0; i < size; i++) {
+            const geometry_msgs::Point &position = _path.poses[i].pose.position;
+            column[i] = axis == 0 ? position.x : (axis == 1 ? position.y : position.z);
+        }
+        encodeColumn(column.data(), size, _resolution, data);
+    }
+
+    return data;
+}
+
+bool decodePath(const uint8_t *_data, size_t _data_size, nav_msgs::Path &_path) {
+    PathCodecHeader header;
+    if (_data_size < sizeof(header)) return false;
+    std::memcpy(&header, _data, sizeof(header));
+    if (std::memcmp(header.magic_, kMagic, sizeof(kMagic)) != 0 || header.version_ != kVersion) return false;
+    size_t size = header.size_;
+    std::vector<double> columns(3 * size);
+    size_t pos = sizeof(header);
+    for (int axis = 0; axis < 3 && size > 0; axis++) {
+        size_t read = decodeColumn(_data + pos, _data_size - pos, size, header.resolution_, &columns[axis * size]);
+        if (read == 0) return false;
+        pos += read;
+    }
+    _path.poses.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        geometry_msgs::Pose &pose = _path.poses[i].pose;
+        pose.position.x = columns[i];
+        pose.position.y = columns[size + i];
+        pose.position.z = columns[2 * size + i];
+        pose.orientation.x = pose.orientation.y = pose.orientation.z = 0;
+        pose.orientation.w = 1;
+    }
+
+    return true;
+}
+
+upat_follower::CompressedPath toCompressedPath(const nav_msgs::Path &_path, double _resolution) {
+    upat_follower::CompressedPath compressed_path;
+    compressed_path.header = _path.header;
+    compressed_path.resolution = _resolution;
+    compressed_path.size = _path.poses.size();
+    std::vector<double> column(_path.poses.size());
+    for (int axis = 0; axis < 3; axis++) {
+        for (size_t i = 0; i < column.size(); i++) {
+            const geometry_msgs::Point &position = _path.poses[i].pose.position;
+            column[i] = axis == 0 ? position.x : (axis == 1 ? position.y : position.z);
+        }
+        encodeColumn(column.data(), column.size(), _resolution, compressed_path.data);
+    }
+
+    return compressed_path;
+}
+
+nav_msgs::Path toPath(const upat_follower::CompressedPath &_compressed_path) {
+    nav_msgs::Path path;
+    path.header = _compressed_path.header;
+    size_t size = _compressed_path.size;
+    std::vector<double> columns(3 * size);
+    size_t pos = 0;
+    for (int axis = 0; axis < 3 && size > 0; axis++) {
+        size_t read = decodeColumn(_compressed_path.data.data() + pos, _compressed_path.data.size() - pos, size, _compressed_path.resolution, &columns[axis * size]);
+        if (read == 0) return path;
+        pos += read;
+    }
+    path.poses.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        path.poses[i].pose.position.x = columns[i];
+        path.poses[i].pose.position.y = columns[size + i];
+        path.poses[i].pose.position.z = columns[2 * size + i];
+        path.poses[i].pose.orientation.w = 1;
+    }
+
+    return path;
+}
+
+}  // namespace upat_follower
\ No newline at end of file
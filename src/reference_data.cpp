@@ -0,0 +1,77 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ros/ros.h>
+#include <upat_follower/follower.h>
+#include <upat_follower/mission_io.h>
+#include <upat_follower/parallel.h>
+#include <upat_follower/reference_data.h>
+#include <algorithm>
+
+namespace upat_follower {
+
+namespace {
+
+enum reference_file_t { file_init_,
+                        file_trajectory_,
+                        file_interp1_,
+                        file_cubic_spline_loyal_,
+                        file_cubic_spline_,
+                        file_count_ };
+
+const char *const kFileNames[file_count_] = {"/init.csv", "/trajectory.csv", "/interp1.csv", "/cubic_spline_loyal.csv", "/cubic_spline.csv"};
+
+}  // namespace
+
+bool generateReferenceData(const std::vector<ReferenceMission> &_missions, int _threads) {
+    std::vector<char> written(_missions.size() * file_count_, 1);
+    parallelFor(written.size(), [&](int _i) {
+        const ReferenceMission &mission = _missions[_i / file_count_];
+        int file = _i % file_count_;
+        if (file != file_init_ && mission.init_path.poses.size() < 2) return;
+        nav_msgs::Path out_path;
+        // Own Follower, and so own Generator, for every file
+        upat_follower::Follower follower(1);
+        switch (file) {
+            case file_init_:
+                out_path = mission.init_path;
+                break;
+            case file_trajectory_:
+                if (mission.times.size() != mission.init_path.poses.size()) return;
+                out_path = follower.prepareTrajectory(mission.init_path, mission.times);
+                break;
+            case file_interp1_:
+                out_path = follower.preparePath(mission.init_path, 0);
+                break;
+            case file_cubic_spline_loyal_:
+                out_path = follower.preparePath(mission.init_path, 1);
+                break;
+            case file_cubic_spline_:
+                out_path = follower.preparePath(mission.init_path, 2);
+                break;
+        }
+        written[_i] = pathToCsv(mission.folder + kFileNames[file], out_path);
+    },
+                _threads);
+
+    return std::count(written.begin(), written.end(), 0) == 0;
+}
+
+}  // namespace upat_follower
\ No newline at end of file
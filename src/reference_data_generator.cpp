@@ -0,0 +1,93 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <ros/ros.h>
+#include <upat_follower/cli.h>
+#include <upat_follower/mission_io.h>
+#include <upat_follower/reference_data.h>
+#include <dirent.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Regenerate the reference data of tests_generator, every file on its own thread:
+// $ rosrun upat_follower reference_data_generator --mission config/cubic.csv --times config/times.csv --output tests/splines
+// or the fixtures of every mission of a folder, each into <output>/<mission name> (trajectory from <name>_times.csv):
+// $ rosrun upat_follower reference_data_generator --missions data/missions --output /tmp/fixtures
+
+int main(int _argc, char **_argv) {
+    // No master is needed: nothing is advertised and rosout is disabled
+    ros::init(_argc, _argv, "reference_data_generator", ros::init_options::AnonymousName | ros::init_options::NoRosout | ros::init_options::NoSigintHandler);
+
+    std::map<std::string, std::string> args;
+    args["output"] = ".";
+    args["threads"] = "0";
+    upat_follower::parseArgs(_argc, _argv, args);
+    if (args["mission"].empty() == args["missions"].empty()) {
+        std::cerr << "Usage: reference_data_generator --mission <waypoints.csv> [--times <times.csv>] [--output <folder>] [--threads n]" << std::endl
+                  << "       reference_data_generator --missions <folder> [--output <folder>] [--threads n]" << std::endl;
+        return 2;
+    }
+
+    std::vector<upat_follower::ReferenceMission> missions;
+    if (!args["mission"].empty()) {
+        upat_follower::ReferenceMission mission;
+        mission.init_path = upat_follower::csvToPath(args["mission"]);
+        if (!args["times"].empty()) mission.times = upat_follower::csvToVector(args["times"]);
+        mission.folder = args["output"];
+        missions.push_back(mission);
+    } else {
+        DIR *dir = opendir(args["missions"].c_str());
+        if (!dir) {
+            std::cerr << "Could not open " << args["missions"] << std::endl;
+            return 2;
+        }
+        std::vector<std::string> names;
+        for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir)) {
+            std::string file_name = entry->d_name;
+            if (upat_follower::endsWith(file_name, ".csv") && !upat_follower::endsWith(file_name, "_times.csv")) names.push_back(file_name.substr(0, file_name.size() - 4));
+        }
+        closedir(dir);
+        std::sort(names.begin(), names.end());
+        for (int i = 0; i < names.size(); i++) {
+            std::string mission_file = args["missions"] + "/" + names[i];
+            upat_follower::ReferenceMission mission;
+            mission.init_path = upat_follower::csvToPath(mission_file + ".csv");
+            if (upat_follower::isFile(mission_file + "_times.csv")) mission.times = upat_follower::csvToVector(mission_file + "_times.csv");
+            mission.folder = args["output"] + "/" + names[i];
+            mkdir(mission.folder.c_str(), 0777);
+            missions.push_back(mission);
+        }
+    }
+    for (int i = 0; i < missions.size(); i++) {
+        if (missions[i].init_path.poses.size() < 2) std::cerr << "Mission of " << missions[i].folder << " needs two waypoints at least, only init.csv is written" << std::endl;
+        if (!missions[i].times.empty() && missions[i].times.size() != missions[i].init_path.poses.size()) std::cerr << "Trajectory of " << missions[i].folder << " needs one time per waypoint, skipped" << std::endl;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    bool written = upat_follower::generateReferenceData(missions, std::atoi(args["threads"].c_str()));
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Missions: " << missions.size() << ", seconds: " << elapsed << std::endl;
+
+    return written ? 0 : 1;
+}
\ No newline at end of file
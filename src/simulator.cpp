@@ -0,0 +1,116 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <upat_follower/simulator.h>
+#include <iomanip>
+
+namespace upat_follower {
+
+Simulator::Simulator(double _lag, double _max_acceleration, double _wind_stddev, int _seed)
+    : lag_(_lag), max_acceleration_(_max_acceleration), wind_stddev_(_wind_stddev), random_engine_(_seed), wind_distribution_(0.0, 1.0) {
+    reset(Eigen::Vector3d::Zero());
+}
+
+Simulator::~Simulator() {
+}
+
+void Simulator::reset(Eigen::Vector3d _position) {
+    position_ = _position;
+    velocity_ = Eigen::Vector3d::Zero();
+    time_ = 0.0;
+}
+
+void Simulator::step(const geometry_msgs::TwistStamped &_velocity, double _dt) {
+    Eigen::Vector3d command(_velocity.twist.linear.x, _velocity.twist.linear.y, _velocity.twist.linear.z);
+    // First order response towards the commanded velocity, limited by the maximum acceleration
+    double gain = lag_ > _dt ? _dt / lag_ : 1.0;
+    Eigen::Vector3d delta_velocity = (command - velocity_) * gain;
+    if (max_acceleration_ > 0 && delta_velocity.norm() > max_acceleration_ * _dt) {
+        delta_velocity = delta_velocity.normalized() * max_acceleration_ * _dt;
+    }
+    velocity_ += delta_velocity;
+    Eigen::Vector3d wind = Eigen::Vector3d::Zero();
+    if (wind_stddev_ > 0) {
+        wind = Eigen::Vector3d(wind_distribution_(random_engine_), wind_distribution_(random_engine_), wind_distribution_(random_engine_)) * wind_stddev_;
+    }
+    position_ += (velocity_ + wind) * _dt;
+    time_ += _dt;
+}
+
+geometry_msgs::PoseStamped Simulator::pose() {
+    geometry_msgs::PoseStamped pose;
+    pose.header.frame_id = frame_id_;
+    pose.header.stamp = ros::Time(time_);
+    pose.pose.position.x = position_(0);
+    pose.pose.position.y = position_(1);
+    pose.pose.position.z = position_(2);
+    pose.pose.orientation.w = 1;
+
+    return pose;
+}
+
+bool Simulator::runMission(upat_follower::Follower &_follower, const nav_msgs::Path &_target_path, const nav_msgs::Path &_reference_path) {
+    normal_distances_.clear();
+    mission_time_ = mean_normal_distance_ = rms_normal_distance_ = max_normal_distance_ = 0.0;
+    if (_target_path.poses.size() < 2) return false;
+    frame_id_ = _target_path.header.frame_id;
+    const geometry_msgs::Point &front = _target_path.poses.front().pose.position;
+    const geometry_msgs::Point &back = _target_path.poses.back().pose.position;
+    Eigen::Vector3d path_end_p(back.x, back.y, back.z);
+    reset(Eigen::Vector3d(front.x, front.y, front.z));
+    upat_follower::NormalDistance normal_distance_target, normal_distance_reference;
+    double dt = 1.0 / rate_;
+    double sum_distance = 0.0, sum_squared_distance = 0.0;
+    bool reached_end = false;
+    // Same end condition as UALCommunication::runMission
+    while (!reached_end && time_ < max_mission_time_) {
+        geometry_msgs::PoseStamped current_pose = pose();
+        Eigen::Vector3d current_p = position_;
+        if (reach_tolerance_ * 2 > (current_p - path_end_p).norm()) {
+            reached_end = true;
+            break;
+        }
+        _follower.updatePose(current_pose);
+        step(_follower.getVelocity(), dt);
+        Eigen::Vector3f current_point = position_.cast<float>();
+        Eigen::Vector3d row(time_, normal_distance_target.calculate(current_point, _target_path), 0.0);
+        if (_reference_path.poses.size() > 1) row(2) = normal_distance_reference.calculate(current_point, _reference_path);
+        normal_distances_.push_back(row);
+        sum_distance += row(1);
+        sum_squared_distance += row(1) * row(1);
+        if (row(1) > max_normal_distance_) max_normal_distance_ = row(1);
+    }
+    mission_time_ = time_;
+    if (!normal_distances_.empty()) {
+        mean_normal_distance_ = sum_distance / normal_distances_.size();
+        rms_normal_distance_ = sqrt(sum_squared_distance / normal_distances_.size());
+    }
+
+    return reached_end;
+}
+
+void Simulator::saveNormalDistances(std::ofstream &_csv_normal_distances) {
+    _csv_normal_distances << std::fixed << std::setprecision(5);
+    for (int i = 0; i < normal_distances_.size(); i++) {
+        _csv_normal_distances << normal_distances_[i](0) << "," << normal_distances_[i](1) << "," << normal_distances_[i](2) << std::endl;
+    }
+}
+
+}  // namespace upat_follower
@@ -0,0 +1,147 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <upat_follower/streaming_stats.h>
+#include <algorithm>
+#include <cmath>
+
+namespace upat_follower {
+
+P2Quantile::P2Quantile(double _p) : p_(_p) {
+    reset();
+}
+
+void P2Quantile::reset() {
+    count_ = 0;
+    for (int i = 0; i < 5; i++) {
+        heights_[i] = 0.0;
+        positions_[i] = i + 1;
+    }
+    desired_[0] = 1;
+    desired_[1] = 1 + 2 * p_;
+    desired_[2] = 1 + 4 * p_;
+    desired_[3] = 3 + 2 * p_;
+    desired_[4] = 5;
+    increments_[0] = 0;
+    increments_[1] = p_ / 2;
+    increments_[2] = p_;
+    increments_[3] = (1 + p_) / 2;
+    increments_[4] = 1;
+}
+
+void P2Quantile::add(double _x) {
+    if (count_ < 5) {
+        heights_[count_++] = _x;
+        if (count_ == 5) std::sort(heights_, heights_ + 5);
+        return;
+    }
+    count_++;
+    // Cell of the new sample, the extreme markers follow the minimum and the maximum
+    int k;
+    if (_x < heights_[0]) {
+        heights_[0] = _x;
+        k = 0;
+    } else if (_x >= heights_[4]) {
+        heights_[4] = _x;
+        k = 3;
+    } else {
+        k = 0;
+        while (_x >= heights_[k + 1]) k++;
+    }
+    for (int i = k + 1; i < 5; i++) positions_[i] += 1;
+    for (int i = 0; i < 5; i++) desired_[i] += increments_[i];
+    // Move the middle markers towards their desired positions
+    for (int i = 1; i < 4; i++) {
+        double d = desired_[i] - positions_[i];
+        if ((d >= 1 && positions_[i + 1] - positions_[i] > 1) || (d <= -1 && positions_[i - 1] - positions_[i] < -1)) {
+            d = d > 0 ? 1.0 : -1.0;
+            double height = parabolic(i, d);
+            if (height <= heights_[i - 1] || height >= heights_[i + 1]) height = linear(i, d);
+            heights_[i] = height;
+            positions_[i] += d;
+        }
+    }
+}
+
+double P2Quantile::parabolic(int _i, double _d) const {
+    return heights_[_i] + _d / (positions_[_i + 1] - positions_[_i - 1]) *
+                              ((positions_[_i] - positions_[_i - 1] + _d) * (heights_[_i + 1] - heights_[_i]) / (positions_[_i + 1] - positions_[_i]) +
+                               (positions_[_i + 1] - positions_[_i] - _d) * (heights_[_i] - heights_[_i - 1]) / (positions_[_i] - positions_[_i - 1]));
+}
+
+double P2Quantile::linear(int _i, double _d) const {
+    int j = _i + (_d > 0 ? 1 : -1);
+    return heights_[_i] + _d * (heights_[j] - heights_[_i]) / (positions_[j] - positions_[_i]);
+}
+
+double P2Quantile::value() const {
+    if (count_ == 0) return 0.0;
+    if (count_ >= 5) return heights_[2];
+    double sorted[5];
+    std::copy(heights_, heights_ + count_, sorted);
+    std::sort(sorted, sorted + count_);
+    int rank = std::min<int>(count_ - 1, std::max(0, (int)std::ceil(p_ * count_) - 1));
+
+    return sorted[rank];
+}
+
+StreamingStats::StreamingStats() : p50_(0.5), p95_(0.95), p99_(0.99) {
+}
+
+void StreamingStats::add(double _distance) {
+    count_++;
+    sum_ += _distance;
+    sum_squared_ += _distance * _distance;
+    if (_distance > max_) max_ = _distance;
+    p50_.add(_distance);
+    p95_.add(_distance);
+    p99_.add(_distance);
+}
+
+void StreamingStats::reset() {
+    count_ = 0;
+    sum_ = sum_squared_ = max_ = 0.0;
+    p50_.reset();
+    p95_.reset();
+    p99_.reset();
+}
+
+double StreamingStats::mean() const {
+    return count_ > 0 ? sum_ / count_ : 0.0;
+}
+
+double StreamingStats::rms() const {
+    return count_ > 0 ? std::sqrt(sum_squared_ / count_) : 0.0;
+}
+
+upat_follower::ErrorStats StreamingStats::toMsg() const {
+    upat_follower::ErrorStats msg;
+    msg.count = count_;
+    msg.mean = mean();
+    msg.rms = rms();
+    msg.max = max_;
+    msg.p50 = p50_.value();
+    msg.p95 = p95_.value();
+    msg.p99 = p99_.value();
+
+    return msg;
+}
+
+}  // namespace upat_follower
\ No newline at end of file
@@ -0,0 +1,142 @@
+
+//----------------------------------------------------------------------------------------------------------------------
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Hector Perez Leon
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <upat_follower/trace.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace upat_follower {
+
+std::atomic<bool> tracing_enabled(false);
+
+namespace {
+
+struct TraceEvent {
+    const char *name_;
+    int64_t begin_ns_;
+    int64_t end_ns_;
+};
+
+// Written only by its thread, read when dumping
+struct TraceRing {
+    TraceRing(size_t _size, int _tid) : events_(_size), tid_(_tid) {}
+    std::vector<TraceEvent> events_;
+    std::atomic<uint64_t> count_{0};
+    int tid_;
+};
+
+// Rings outlive their threads, the trace is written on exit
+class TraceRegistry {
+   public:
+    ~TraceRegistry() {
+        if (!file_name_.empty()) dump(file_name_);
+    }
+
+    TraceRing *addRing() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings_.emplace_back(new TraceRing(ring_size_, rings_.size()));
+        return rings_.back().get();
+    }
+
+    void configure(const std::string &_file_name, size_t _ring_size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_name_.empty()) file_name_ = _file_name.empty() ? "/tmp/upat_follower_trace_" + std::to_string(getpid()) + ".json" : _file_name;
+        if (_ring_size > 0) ring_size_ = _ring_size;
+    }
+
+    void cancelExit() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_name_.clear();
+    }
+
+    bool dump(const std::string &_file_name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        FILE *file = fopen(_file_name.c_str(), "w");
+        if (!file) return false;
+        int pid = getpid();
+        bool first = true;
+        fprintf(file, "{\"traceEvents\":[");
+        for (size_t r = 0; r < rings_.size(); r++) {
+            const TraceRing &ring = *rings_[r];
+            uint64_t count = ring.count_.load(std::memory_order_acquire);
+            uint64_t size = ring.events_.size();
+            for (uint64_t i = count > size ? count - size : 0; i < count; i++) {
+                const TraceEvent &event = ring.events_[i % size];
+                fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",",
+                        event.name_, pid, ring.tid_, event.begin_ns_ * 1e-3, (event.end_ns_ - event.begin_ns_) * 1e-3);
+                first = false;
+            }
+        }
+        fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+        return fclose(file) == 0;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<TraceRing> > rings_;
+    std::string file_name_;
+    size_t ring_size_ = 1 << 16;
+};
+
+TraceRegistry &registry() {
+    static TraceRegistry registry;
+    return registry;
+}
+
+thread_local TraceRing *thread_ring = nullptr;
+
+}  // namespace
+
+void enableTracing(const std::string &_file_name, size_t _ring_size) {
+    registry().configure(_file_name, _ring_size);
+    tracing_enabled.store(true, std::memory_order_relaxed);
+}
+
+void disableTracing() {
+    tracing_enabled.store(false, std::memory_order_relaxed);
+}
+
+void cancelExitTrace() {
+    registry().cancelExit();
+}
+
+bool dumpTrace(const std::string &_file_name) {
+    return registry().dump(_file_name);
+}
+
+int64_t TraceSpan::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void TraceSpan::record(const char *_name, int64_t _begin_ns, int64_t _end_ns) {
+    if (!thread_ring) thread_ring = registry().addRing();
+    uint64_t count = thread_ring->count_.load(std::memory_order_relaxed);
+    TraceEvent &event = thread_ring->events_[count % thread_ring->events_.size()];
+    event.name_ = _name;
+    event.begin_ns_ = _begin_ns;
+    event.end_ns_ = _end_ns;
+    thread_ring->count_.store(count + 1, std::memory_order_release);
+}
+
+}  // namespace upat_follower
\ No newline at end of file
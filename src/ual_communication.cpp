@@ -18,19 +18,46 @@
 //----------------------------------------------------------------------------------------------------------------------
 
 #include <upat_follower/ual_communication.h>
+#include <boost/make_shared.hpp>
 
 namespace upat_follower {
 
-UALCommunication::UALCommunication() : nh_(), pnh_("~") {
+namespace {
+
+template <typename T>
+bool isReady(const std::future<T> &_future) {
+    return _future.valid() && _future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+}  // namespace
+
+UALCommunication::UALCommunication() : UALCommunication(ros::NodeHandle(), ros::NodeHandle("~")) {
+}
+
+UALCommunication::UALCommunication(ros::NodeHandle _nh, ros::NodeHandle _pnh) : nh_(_nh), pnh_(_pnh) {
     // Parameters
     pnh_.getParam("uav_id", uav_id_);
     pnh_.getParam("save_test_data", save_test_);
     pnh_.getParam("trajectory", trajectory_);
     pnh_.getParam("path", init_path_name_);
+    pnh_.getParam("legs", legs_names_);
     pnh_.getParam("pkg_name", pkg_name_);
     pnh_.getParam("reach_tolerance", reach_tolerance_);
     pnh_.getParam("use_class", use_class_);
+    pnh_.param<bool>("in_process", in_process_, false);
     pnh_.getParam("generator_mode", generator_mode_);
+    pnh_.param<int>("trail_capacity", trail_capacity_, 10000);
+    pnh_.param<int>("trail_decimation", trail_decimation_, 1);
+    pnh_.param<std::string>("path_cache", path_cache_, "");
+    pnh_.param<double>("pub_rate", pub_rate_, 30.0);
+    pnh_.param<double>("loop_report_period", loop_report_period_, 10.0);
+    bool trace = false;
+    std::string trace_file;
+    pnh_.param<bool>("trace", trace, false);
+    pnh_.param<std::string>("trace_file", trace_file, "");
+    if (trace) enableTracing(trace_file);
+    if (!path_cache_.empty() && !use_class_) ROS_WARN("path_cache is only used with use_class, the follower node generates its own path");
+    if (in_process_ && use_class_) in_process_ = false;
     // Subscriptions
     sub_pose_ = nh_.subscribe("/uav_" + std::to_string(uav_id_) + "/ual/pose", 0, &UALCommunication::ualPoseCallback, this);
     sub_state_ = nh_.subscribe("/uav_" + std::to_string(uav_id_) + "/ual/state", 0, &UALCommunication::ualStateCallback, this);
@@ -38,18 +65,38 @@ UALCommunication::UALCommunication() : nh_(), pnh_("~") {
     // Publishers
     pub_set_pose_ = nh_.advertise<geometry_msgs::PoseStamped>("/uav_" + std::to_string(uav_id_) + "/ual/set_pose", 1000);
     pub_set_velocity_ = nh_.advertise<geometry_msgs::TwistStamped>("/uav_" + std::to_string(uav_id_) + "/ual/set_velocity", 1000);
+    pub_current_path_increment_ = nh_.advertise<upat_follower::PathIncrement>("/upat_follower/ual_communication/uav_" + std::to_string(uav_id_) + "/current_path_increment", 100);
+    if (in_process_) pub_prepared_path_ = nh_.advertise<upat_follower::PreparedPath>("/upat_follower/ual_communication/uav_" + std::to_string(uav_id_) + "/prepared_path", 1, true);
     // Services
     client_take_off_ = nh_.serviceClient<uav_abstraction_layer::TakeOff>("/uav_" + std::to_string(uav_id_) + "/ual/take_off");
     client_land_ = nh_.serviceClient<uav_abstraction_layer::Land>("/uav_" + std::to_string(uav_id_) + "/ual/land");
-    client_prepare_path_ = nh_.serviceClient<upat_follower::PreparePath>("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/prepare_path");
-    client_prepare_trajectory_ = nh_.serviceClient<upat_follower::PrepareTrajectory>("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/prepare_trajectory");
+    client_generate_path_shared_ = nh_.serviceClient<upat_follower::GeneratePathShared>("/upat_follower/generator/generate_path_shared");
+    client_generate_trajectory_shared_ = nh_.serviceClient<upat_follower::GenerateTrajectoryShared>("/upat_follower/generator/generate_trajectory_shared");
+    client_load_shared_path_ = nh_.serviceClient<upat_follower::LoadSharedPath>("/upat_follower/follower/uav_" + std::to_string(uav_id_) + "/load_shared_path");
     client_visualize_ = nh_.serviceClient<upat_follower::Visualize>("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/visualize");
-    // Flags
-    on_path_ = false;
-    end_path_ = false;
-    // Initialize path
-    init_path_ = csvToPath("/" + init_path_name_ + ".csv");
-    times_ = csvToVector("/times.csv");
+    // Follower used when use_class is set
+    follower_.reset(new upat_follower::Follower(uav_id_));
+    // Flight history, bounded to the last trail_capacity stored poses
+    current_path_.setCapacity(trail_capacity_);
+    current_path_.setDecimation(trail_decimation_);
+    // Mission
+    mission_state_ = state_preparing_;
+    last_loop_ = last_loop_report_ = std::chrono::steady_clock::now();
+    // Initialize legs, a single one named by path unless legs is set
+    std::string config_folder = ros::package::getPath(pkg_name_) + "/config/";
+    std::vector<std::string> leg_names;
+    std::replace(legs_names_.begin(), legs_names_.end(), ',', ' ');
+    std::stringstream slegs(legs_names_);
+    std::string leg_name;
+    while (slegs >> leg_name) leg_names.push_back(leg_name);
+    if (leg_names.empty()) leg_names.push_back(init_path_name_);
+    legs_.resize(leg_names.size());
+    for (int i = 0; i < legs_.size(); i++) {
+        legs_[i].init_path = csvToPath(config_folder + leg_names[i] + ".csv", "uav_" + std::to_string(uav_id_) + "_home");
+        if (trajectory_) legs_[i].times = csvToVector(config_folder + (legs_.size() > 1 ? leg_names[i] + "_times.csv" : "times.csv"));
+    }
+    init_path_ = legs_.front().init_path;
+    times_ = legs_.front().times;
     // Save data
     if (save_test_) {
         std::string pkg_name_path = ros::package::getPath(pkg_name_);
@@ -58,72 +105,10 @@ UALCommunication::UALCommunication() : nh_(), pnh_("~") {
 }
 
 UALCommunication::~UALCommunication() {
-}
-
-nav_msgs::Path UALCommunication::constructPath(std::vector<double> _wps_x, std::vector<double> _wps_y, std::vector<double> _wps_z, std::string frame_id) {
-    nav_msgs::Path out_path;
-    std::vector<geometry_msgs::PoseStamped> poses(_wps_x.size());
-    out_path.header.frame_id = frame_id;
-    for (int i = 0; i < _wps_x.size(); i++) {
-        poses.at(i).pose.position.x = _wps_x[i];
-        poses.at(i).pose.position.y = _wps_y[i];
-        poses.at(i).pose.position.z = _wps_z[i];
-        poses.at(i).pose.orientation.x = 0;
-        poses.at(i).pose.orientation.y = 0;
-        poses.at(i).pose.orientation.z = 0;
-        poses.at(i).pose.orientation.w = 1;
-    }
-    out_path.poses = poses;
-    return out_path;
-}
-
-nav_msgs::Path UALCommunication::csvToPath(std::string _file_name) {
-    nav_msgs::Path out_path;
-    std::string pkg_name_path = ros::package::getPath(pkg_name_);
-    std::string folder_name = pkg_name_path + "/config" + _file_name;
-    std::fstream read_csv;
-    read_csv.open(folder_name);
-    std::vector<double> list_x, list_y, list_z;
-    if (read_csv.is_open()) {
-        while (read_csv.good()) {
-            std::string x, y, z;
-            double dx, dy, dz;
-            getline(read_csv, x, ',');
-            getline(read_csv, y, ',');
-            getline(read_csv, z, '\n');
-            std::stringstream sx(x);
-            std::stringstream sy(y);
-            std::stringstream sz(z);
-            sx >> dx;
-            sy >> dy;
-            sz >> dz;
-            list_x.push_back(dx);
-            list_y.push_back(dy);
-            list_z.push_back(dz);
-        }
-    }
-
-    return constructPath(list_x, list_y, list_z, "uav_" + std::to_string(uav_id_) + "_home");
-}
-
-std::vector<double> UALCommunication::csvToVector(std::string _file_name) {
-    std::vector<double> out_vector;
-    std::string pkg_name_path = ros::package::getPath(pkg_name_);
-    std::string folder_name = pkg_name_path + "/config" + _file_name;
-    std::fstream read_csv;
-    read_csv.open(folder_name);
-    if (read_csv.is_open()) {
-        while (read_csv.good()) {
-            std::string x;
-            double dx;
-            getline(read_csv, x, '\n');
-            std::stringstream sx(x);
-            sx >> dx;
-            out_vector.push_back(dx);
-        }
-    }
-
-    return out_vector;
+    // Background operations use the members, wait for them
+    if (prepare_future_.valid()) prepare_future_.wait();
+    if (take_off_future_.valid()) take_off_future_.wait();
+    if (land_future_.valid()) land_future_.wait();
 }
 
 void UALCommunication::ualPoseCallback(const geometry_msgs::PoseStamped::ConstPtr &_ual_pose) {
@@ -139,84 +124,171 @@ void UALCommunication::velocityCallback(const geometry_msgs::TwistStamped &_velo
 }
 
 void UALCommunication::saveDataForTesting() {
-    static upat_follower::Follower follower_save_tests(uav_id_);
-    std::ofstream csv_cubic_loyal, csv_cubic, csv_interp1, csv_init, csv_trajectory;
-    target_path_ = follower_save_tests.prepareTrajectory(init_path_, times_);
-    csv_trajectory.open(folder_data_name_ + "/trajectory.csv");
-    csv_trajectory << std::fixed << std::setprecision(5);
-    for (int i = 0; i < target_path_.poses.size(); i++) {
-        csv_trajectory << target_path_.poses.at(i).pose.position.x << ", " << target_path_.poses.at(i).pose.position.y << ", " << target_path_.poses.at(i).pose.position.z << std::endl;
+    ReferenceMission mission;
+    mission.init_path = init_path_;
+    mission.times = times_;
+    mission.folder = folder_data_name_;
+    if (!generateReferenceData(std::vector<ReferenceMission>(1, mission))) ROS_WARN("Could not save data for testing in %s", folder_data_name_.c_str());
+}
+
+uint64_t UALCommunication::missionHash(int _leg) {
+    if (trajectory_) return hashMission(legs_.at(_leg).init_path, legs_.at(_leg).times, PathCache::trajectory_mode_);
+    return hashMission(legs_.at(_leg).init_path, std::vector<double>(), generator_mode_);
+}
+
+std::string UALCommunication::legCacheFile(int _leg) {
+    if (path_cache_.empty() || legs_.size() == 1) return path_cache_;
+    return path_cache_ + "." + std::to_string(_leg);
+}
+
+void UALCommunication::callVisualization() {
+    UPAT_TRACE_SCOPE("UALCommunication::callVisualization");
+    // Init and generated paths only change when the mission is prepared, the flight history is sent as increments
+    if (paths_changed_) {
+        upat_follower::Visualize visualize;
+        visualize.request.init_path = init_path_;
+        visualize.request.generated_path = target_path_;
+        if (client_visualize_.call(visualize)) paths_changed_ = false;
     }
-    csv_trajectory.close();
-    csv_init.open(folder_data_name_ + "/init.csv");
-    csv_init << std::fixed << std::setprecision(5);
-    for (int i = 0; i < init_path_.poses.size(); i++) {
-        csv_init << init_path_.poses.at(i).pose.position.x << ", " << init_path_.poses.at(i).pose.position.y << ", " << init_path_.poses.at(i).pose.position.z << std::endl;
+    if (current_path_.nextSeq() > synced_seq_) {
+        upat_follower::PathIncrement::Ptr increment = boost::make_shared<upat_follower::PathIncrement>();
+        increment->header.stamp = ros::Time::now();
+        increment->header.frame_id = ual_pose_.header.frame_id;
+        increment->first_seq = current_path_.copySince(synced_seq_, increment->poses);
+        pub_current_path_increment_.publish(increment);
+        synced_seq_ = current_path_.nextSeq();
     }
-    csv_init.close();
-    target_path_ = follower_save_tests.preparePath(init_path_, 0);
-    csv_interp1.open(folder_data_name_ + "/interp1.csv");
-    csv_interp1 << std::fixed << std::setprecision(5);
-    for (int i = 0; i < target_path_.poses.size(); i++) {
-        csv_interp1 << target_path_.poses.at(i).pose.position.x << ", " << target_path_.poses.at(i).pose.position.y << ", " << target_path_.poses.at(i).pose.position.z << std::endl;
+}
+
+PathCache UALCommunication::prepareLeg(int _leg) {
+    UPAT_TRACE_SCOPE("UALCommunication::prepareLeg");
+    const MissionLeg &leg = legs_.at(_leg);
+    PathCache cache;
+    if (_leg == 0 && save_test_) saveDataForTesting();
+    if (!use_class_) {
+        // Generated by the generator node into shared memory while the follower node flies the current leg, it is
+        // handed to the follower node by switchLeg
+        std::string handle;
+        bool generated = false;
+        if (trajectory_) {
+            upat_follower::GenerateTrajectoryShared generate_trajectory;
+            std::vector<double> percentages = Follower(uav_id_).timesToMaxVelPercentage(leg.init_path, leg.times);
+            generate_trajectory.request.times.assign(percentages.begin(), percentages.end());
+            generate_trajectory.request.init_path = toFlatPath(leg.init_path);
+            generated = client_generate_trajectory_shared_.call(generate_trajectory);
+            handle = generate_trajectory.response.handle;
+        } else {
+            upat_follower::GeneratePathShared generate_path;
+            generate_path.request.init_path = toFlatPath(leg.init_path);
+            generate_path.request.generator_mode = 2;
+            generated = client_generate_path_shared_.call(generate_path);
+            handle = generate_path.response.handle;
+        }
+        // The path is also needed here, to reach its ends and to visualize it
+        if (!generated || !loadSharedPathCache(handle, cache)) return PathCache();
+        prepared_handle_ = handle;
+        return cache;
     }
-    csv_interp1.close();
-    target_path_ = follower_save_tests.preparePath(init_path_, 1);
-    csv_cubic_loyal.open(folder_data_name_ + "/cubic_spline_loyal.csv");
-    csv_cubic_loyal << std::fixed << std::setprecision(5);
-    for (int i = 0; i < target_path_.poses.size(); i++) {
-        csv_cubic_loyal << target_path_.poses.at(i).pose.position.x << ", " << target_path_.poses.at(i).pose.position.y << ", " << target_path_.poses.at(i).pose.position.z << std::endl;
+    // Generated apart from follower_, which may be flying the previous leg
+    std::string cache_file = legCacheFile(_leg);
+    uint64_t hash = missionHash(_leg);
+    if (!cache_file.empty() && loadPathCache(cache_file, cache)) {
+        if (cache.hash_ == hash) return cache;
+        ROS_WARN("Path cache %s was generated for another mission, generating it again", cache_file.c_str());
     }
-    csv_cubic_loyal.close();
-    target_path_ = follower_save_tests.preparePath(init_path_, 2);
-    csv_cubic.open(folder_data_name_ + "/cubic_spline.csv");
-    csv_cubic << std::fixed << std::setprecision(5);
-    for (int i = 0; i < target_path_.poses.size(); i++) {
-        csv_cubic << target_path_.poses.at(i).pose.position.x << ", " << target_path_.poses.at(i).pose.position.y << ", " << target_path_.poses.at(i).pose.position.z << std::endl;
+    upat_follower::Follower leg_follower(uav_id_);
+    if (trajectory_) {
+        leg_follower.prepareTrajectory(leg.init_path, leg.times);
+    } else {
+        leg_follower.preparePath(leg.init_path, generator_mode_, 0.4, 1.0);
     }
-    csv_cubic.close();
+    cache = leg_follower.getPathCache();
+    cache.hash_ = hash;
+    if (!cache_file.empty() && savePathCache(cache_file, cache)) ROS_INFO("Generated path saved in %s", cache_file.c_str());
+
+    return cache;
 }
 
-void UALCommunication::callVisualization() {
-    upat_follower::Visualize visualize;
-    visualize.request.init_path = init_path_;
-    visualize.request.generated_path = target_path_;
-    visualize.request.current_path = current_path_;
-    client_visualize_.call(visualize);
+void UALCommunication::prefetchNextLeg() {
+    int next_leg = mission_state_ == state_preparing_ ? 0 : current_leg_ + 1;
+    if (next_leg >= legs_.size() || prepare_future_.valid()) return;
+    prepared_leg_ = next_leg;
+    prepare_future_ = std::async(std::launch::async, &UALCommunication::prepareLeg, this, next_leg);
 }
 
-void UALCommunication::runMission() {
-    static upat_follower::Follower follower_(uav_id_);
+bool UALCommunication::switchLeg() {
+    if (!isReady(prepare_future_)) return false;
+    PathCache cache = prepare_future_.get();
+    bool loaded = cache.path_.poses.size() > 0;
+    if (loaded && use_class_) {
+        loaded = follower_->loadPathCache(cache, 0.4, 1.0);
+    } else if (loaded && in_process_) {
+        // The follower and visualization nodelets share this message, it is neither serialized nor read again from the
+        // shared memory segment
+        upat_follower::PreparedPath::Ptr prepared_path = boost::make_shared<upat_follower::PreparedPath>();
+        prepared_path->header.stamp = ros::Time::now();
+        prepared_path->header.frame_id = cache.path_.header.frame_id;
+        prepared_path->version = cache.hash_;
+        prepared_path->init_path = legs_.at(prepared_leg_).init_path;
+        prepared_path->path = cache.path_;
+        prepared_path->speed_percentages = cache.speed_;
+        prepared_path->max_velocity = cache.max_velocity_;
+        prepared_path->generator_mode = cache.generator_mode_;
+        prepared_path->look_ahead = 1.2;
+        prepared_path->cruising_speed = 1.0;
+        pub_prepared_path_.publish(prepared_path);
+    } else if (loaded) {
+        upat_follower::LoadSharedPath load_shared_path;
+        load_shared_path.request.handle = prepared_handle_;
+        load_shared_path.request.version = cache.hash_;
+        load_shared_path.request.look_ahead = 1.2;
+        load_shared_path.request.cruising_speed = 1.0;
+        loaded = client_load_shared_path_.call(load_shared_path) && load_shared_path.response.success;
+    }
+    if (!loaded) {
+        ROS_ERROR("Preparation of leg %d failed, trying again", prepared_leg_);
+        return false;
+    }
+    current_leg_ = prepared_leg_;
+    init_path_ = legs_.at(current_leg_).init_path;
+    times_ = legs_.at(current_leg_).times;
+    target_path_ = cache.path_;
+    paths_changed_ = !in_process_;  // In process, visualization already has them from the prepared path
+    if (legs_.size() > 1) ROS_INFO("Leg %d of %d", current_leg_ + 1, static_cast<int>(legs_.size()));
 
-    uav_abstraction_layer::TakeOff take_off;
-    uav_abstraction_layer::Land land;
-    upat_follower::PreparePath prepare_path;
-    upat_follower::PrepareTrajectory prepare_trajectory;
-    if (target_path_.poses.size() < 1) {
-        if (save_test_) saveDataForTesting();
-        if (trajectory_) {
-            for (int i = 0; i < times_.size(); i++) {
-                std_msgs::Float32 v_percentage;
-                v_percentage.data = times_[i];
-                prepare_trajectory.request.times.push_back(v_percentage);
-            }
-            prepare_trajectory.request.init_path = init_path_;
-            if (!use_class_) {
-                client_prepare_trajectory_.call(prepare_trajectory);
-                target_path_ = prepare_trajectory.response.generated_path;
-            }
-            if (use_class_) target_path_ = follower_.prepareTrajectory(init_path_, times_);
-        } else {
-            prepare_path.request.init_path = init_path_;
-            prepare_path.request.generator_mode.data = 2;
-            prepare_path.request.look_ahead.data = 1.2;
-            prepare_path.request.cruising_speed.data = 1.0;
-            if (!use_class_) {
-                client_prepare_path_.call(prepare_path);
-                target_path_ = prepare_path.response.generated_path;
-            }
-            if (use_class_) target_path_ = follower_.preparePath(init_path_, generator_mode_, 0.4, 1.0);
-        }
+    return true;
+}
+
+void UALCommunication::measureLoop() {
+    if (loop_report_period_ <= 0) return;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double period_us = std::chrono::duration<double, std::micro>(now - last_loop_).count();
+    last_loop_ = now;
+    loop_jitter_.add(std::fabs(period_us - 1e6 / pub_rate_));
+    if (period_us > 1.5e6 / pub_rate_) late_loops_++;
+    if (std::chrono::duration<double>(now - last_loop_report_).count() >= loop_report_period_) {
+        upat_follower::ErrorStats jitter = loop_jitter_.toMsg();
+        ROS_INFO("Loop jitter over %d ticks: mean %.0f us, P50 %.0f us, P95 %.0f us, P99 %.0f us, max %.0f us, %d ticks late by more than half a period", static_cast<int>(jitter.count), jitter.mean, jitter.p50, jitter.p95, jitter.p99, jitter.max, late_loops_);
+        loop_jitter_.reset();
+        late_loops_ = 0;
+        last_loop_report_ = now;
+    }
+}
+
+void UALCommunication::runMission() {
+    UPAT_TRACE_SCOPE("UALCommunication::runMission");
+    measureLoop();
+    // Slow operations run in the background, the loop goes on and checks them every tick. The next leg is prepared
+    // while the current one is flown.
+    prefetchNextLeg();
+    if (mission_state_ == state_preparing_) {
+        if (!switchLeg()) return;
+        mission_state_ = state_taking_off_;
+    }
+    if (isReady(take_off_future_) && !take_off_future_.get()) ROS_WARN("Take off failed");
+    if (isReady(land_future_) && !land_future_.get()) {
+        ROS_WARN("Land failed");
+        mission_state_ = state_going_to_end_;
     }
 
     Eigen::Vector3f current_p, path0_p, path_end_p;
@@ -225,45 +297,63 @@ void UALCommunication::runMission() {
     path_end_p = Eigen::Vector3f(target_path_.poses.back().pose.position.x, target_path_.poses.back().pose.position.y, target_path_.poses.back().pose.position.z);
     switch (ual_state_.state) {
         case 2:  // Landed armed
-            if (!end_path_) {
-                take_off.request.height = 12.5;
-                take_off.request.blocking = true;
-                client_take_off_.call(take_off);
+            if (mission_state_ < state_going_to_end_ && !take_off_future_.valid()) {
+                mission_state_ = state_taking_off_;
+                take_off_future_ = std::async(std::launch::async, [this]() {
+                    uav_abstraction_layer::TakeOff take_off;
+                    take_off.request.height = 12.5;
+                    take_off.request.blocking = true;
+                    return client_take_off_.call(take_off);
+                });
             }
             break;
         case 3:  // Taking of
             break;
         case 4:  // Flying auto
-            if (!end_path_) {
-                if (!on_path_) {
+            switch (mission_state_) {
+                case state_taking_off_:
+                case state_going_to_start_:
+                    mission_state_ = state_going_to_start_;
                     if ((current_p - path0_p).norm() > reach_tolerance_ * 2) {
                         pub_set_pose_.publish(target_path_.poses.at(0));
                     } else if (reach_tolerance_ > (current_p - path0_p).norm() && !flag_hover_) {
                         pub_set_pose_.publish(target_path_.poses.front());
-                        on_path_ = true;
+                        mission_state_ = state_following_;
                     }
-                } else {
+                    break;
+                case state_following_:
                     if (reach_tolerance_ * 2 > (current_p - path_end_p).norm()) {
+                        // Go on with the next leg if it is ready, stop at the end otherwise
+                        if (current_leg_ + 1 < legs_.size() && switchLeg()) break;
                         pub_set_pose_.publish(target_path_.poses.back());
-                        on_path_ = false;
-                        end_path_ = true;
+                        mission_state_ = state_going_to_end_;
                     } else {
                         if (use_class_) {
-                            follower_.updatePose(ual_pose_);
-                            velocity_ = follower_.getVelocity();
+                            follower_->updatePose(ual_pose_);
+                            velocity_ = follower_->getVelocity();
                         }
                         pub_set_velocity_.publish(velocity_);
-                        current_path_.header.frame_id = ual_pose_.header.frame_id;
-                        current_path_.poses.push_back(ual_pose_);
+                        current_path_.push(ual_pose_);
+                    }
+                    break;
+                case state_going_to_end_:
+                    if (current_leg_ + 1 < legs_.size()) {
+                        // Hover until the next leg is ready
+                        pub_set_pose_.publish(target_path_.poses.back());
+                        if (switchLeg()) mission_state_ = state_going_to_start_;
+                    } else if (reach_tolerance_ * 2 > (current_p - path_end_p).norm() && (current_p - path_end_p).norm() > reach_tolerance_) {
+                        pub_set_pose_.publish(target_path_.poses.back());
+                    } else if (!land_future_.valid()) {
+                        mission_state_ = state_landing_;
+                        land_future_ = std::async(std::launch::async, [this]() {
+                            uav_abstraction_layer::Land land;
+                            land.request.blocking = true;
+                            return client_land_.call(land);
+                        });
                     }
-                }
-            } else {
-                if (reach_tolerance_ * 2 > (current_p - path_end_p).norm() && (current_p - path_end_p).norm() > reach_tolerance_) {
-                    pub_set_pose_.publish(target_path_.poses.back());
-                } else {
-                    land.request.blocking = true;
-                    client_land_.call(land);
-                }
+                    break;
+                default:
+                    break;
             }
             break;
         case 5:  // Landing
@@ -19,23 +19,85 @@
 
 #include <upat_follower/visualization.h>
 
-Visualization::Visualization() : nh_(), pnh_("~") {
+namespace {
+
+bool samePositions(const nav_msgs::Path &_a, const nav_msgs::Path &_b) {
+    if (_a.poses.size() != _b.poses.size()) return false;
+    for (size_t i = 0; i < _a.poses.size(); i++) {
+        const geometry_msgs::Point &a = _a.poses[i].pose.position;
+        const geometry_msgs::Point &b = _b.poses[i].pose.position;
+        if (a.x != b.x || a.y != b.y || a.z != b.z) return false;
+    }
+
+    return true;
+}
+
+// Segment between waypoints i and i + 1 closest to the point
+int closestSegment(const Eigen::Vector3f &_point, const nav_msgs::Path &_path) {
+    int closest = 0;
+    float min_distance = std::numeric_limits<float>::max();
+    for (int i = 0; i + 1 < _path.poses.size(); i++) {
+        Eigen::Vector3f a(_path.poses[i].pose.position.x, _path.poses[i].pose.position.y, _path.poses[i].pose.position.z);
+        Eigen::Vector3f b(_path.poses[i + 1].pose.position.x, _path.poses[i + 1].pose.position.y, _path.poses[i + 1].pose.position.z);
+        Eigen::Vector3f ab = b - a;
+        float t = ab.squaredNorm() > 0 ? std::min(1.0f, std::max(0.0f, (_point - a).dot(ab) / ab.squaredNorm())) : 0.0f;
+        float distance = (a + t * ab - _point).norm();
+        if (distance < min_distance) {
+            min_distance = distance;
+            closest = i;
+        }
+    }
+
+    return closest;
+}
+
+}  // namespace
+
+Visualization::Visualization() : Visualization(ros::NodeHandle(), ros::NodeHandle("~")) {
+}
+
+Visualization::Visualization(ros::NodeHandle _nh, ros::NodeHandle _pnh) : nh_(_nh), pnh_(_pnh) {
     // Parameters
     pnh_.getParam("uav_id", uav_id_);
     std::string robot_model;
     pnh_.getParam("robot_model", robot_model);
+    pnh_.param<int>("trail_capacity", trail_capacity_, 10000);
+    pnh_.param<int>("max_path_points", max_path_points_, 2000);
+    pnh_.param<int>("trail_chunk_size", trail_chunk_size_, 500);
+    pnh_.param<double>("current_path_rate", current_path_rate_, 1.0);
+    pnh_.param<double>("log_flush_period", log_flush_period_, 0.5);
+    pnh_.param<double>("stats_rate", stats_rate_, 1.0);
+    bool trace = false;
+    std::string trace_file;
+    pnh_.param<bool>("trace", trace, false);
+    pnh_.param<std::string>("trace_file", trace_file, "");
+    if (trace) upat_follower::enableTracing(trace_file);
+    if (trail_chunk_size_ < 2) trail_chunk_size_ = 2;
     // Subscriptions
     sub_pose_ = nh_.subscribe("/uav_" + std::to_string(uav_id_) + "/ual/pose", 0, &Visualization::ualPoseCallback, this);
     sub_state_ = nh_.subscribe("/uav_" + std::to_string(uav_id_) + "/ual/state", 0, &Visualization::ualStateCallback, this);
-    // Publishers
-    pub_init_path_ = nh_.advertise<nav_msgs::Path>("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/init_path", 1);
-    pub_generated_path_ = nh_.advertise<nav_msgs::Path>("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/generated_path", 1);
-    pub_current_path_ = nh_.advertise<nav_msgs::Path>("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/current_path", 1);
+    sub_current_path_increment_ = nh_.subscribe("/upat_follower/ual_communication/uav_" + std::to_string(uav_id_) + "/current_path_increment", 100, &Visualization::currentPathIncrementCallback, this);
+    sub_prepared_path_ = nh_.subscribe("/upat_follower/ual_communication/uav_" + std::to_string(uav_id_) + "/prepared_path", 1, &Visualization::preparedPathCallback, this);
+    // Publishers, paths are latched and only published when they change
+    pub_init_path_ = nh_.advertise<nav_msgs::Path>("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/init_path", 1, true);
+    pub_generated_path_ = nh_.advertise<nav_msgs::Path>("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/generated_path", 1, true);
+    pub_current_path_ = nh_.advertise<nav_msgs::Path>("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/current_path", 1, true);
+    pub_trail_ = nh_.advertise<visualization_msgs::Marker>("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/trail", 10);
+    pub_tracking_stats_ = nh_.advertise<upat_follower::TrackingStats>("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/tracking_stats", 1);
     pub_uav_model_ = nh_.advertise<visualization_msgs::Marker>("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/uav_model", 1);
     // Services
     server_visualize_ = nh_.advertiseService("/upat_follower/visualization/uav_" + std::to_string(uav_id_) + "/visualize", &Visualization::visualCallback, this);
 
     uav_model_ = readModel(robot_model);
+    current_trail_.setCapacity(trail_capacity_);
+    // Flight trail as LINE_STRIP markers of trail_chunk_size points, only the last one changes
+    trail_chunk_.ns = "trail";
+    trail_chunk_.id = 0;
+    trail_chunk_.type = visualization_msgs::Marker::LINE_STRIP;
+    trail_chunk_.action = visualization_msgs::Marker::ADD;
+    trail_chunk_.pose.orientation.w = 1;
+    trail_chunk_.scale.x = 0.05;
+    trail_chunk_.color = uav_model_.color;
 }
 
 Visualization::~Visualization() {
@@ -43,14 +105,107 @@ Visualization::~Visualization() {
 
 bool Visualization::visualCallback(upat_follower::Visualize::Request &_req_visual,
                                    upat_follower::Visualize::Response &_res_visual) {
-    init_path_ = _req_visual.init_path;
-    uav_model_.header.frame_id = init_path_.header.frame_id;
-    generated_path_ = _req_visual.generated_path;
-    current_path_ = _req_visual.current_path;
+    setPaths(_req_visual.init_path, _req_visual.generated_path);
+    // Clients that still send the whole flight history in every request
+    if (_req_visual.current_path.poses.size() > 0) {
+        appendCurrentPath(0, _req_visual.current_path.poses, _req_visual.current_path.header.frame_id);
+    }
 
     return true;
 }
 
+void Visualization::currentPathIncrementCallback(const upat_follower::PathIncrement::ConstPtr &_increment) {
+    // Increments start where the previous one ended, an older one comes from a restarted ual_communication
+    if (_increment->first_seq < current_path_seq_) {
+        ROS_WARN("Flight history restarted at %d, %d poses were received", static_cast<int>(_increment->first_seq), static_cast<int>(current_path_seq_));
+        resetCurrentPath();
+    }
+    appendCurrentPath(_increment->first_seq, _increment->poses, _increment->header.frame_id);
+}
+
+void Visualization::preparedPathCallback(const upat_follower::PreparedPath::ConstPtr &_prepared_path) {
+    // Same paths as the visualize service, shared by ual_communication in the same nodelet manager
+    setPaths(_prepared_path->init_path, _prepared_path->path);
+}
+
+void Visualization::setPaths(const nav_msgs::Path &_init_path, const nav_msgs::Path &_generated_path) {
+    // A new mission or leg restarts the tracking statistics
+    if (!samePositions(init_path_, _init_path) || !samePositions(generated_path_, _generated_path)) {
+        interp1_outdated_ = !samePositions(init_path_, _init_path);
+        normal_distance_generated_path_.reset();
+        normal_distance_init_path_.reset();
+        generated_path_stats_.reset();
+        init_path_stats_.reset();
+        segment_stats_.assign(std::max<int>(1, _init_path.poses.size() - 1), upat_follower::StreamingStats());
+    }
+    init_path_ = _init_path;
+    uav_model_.header.frame_id = init_path_.header.frame_id;
+    generated_path_ = _generated_path;
+    paths_changed_ = true;
+}
+
+void Visualization::appendCurrentPath(uint64_t _first_seq, const std::vector<geometry_msgs::PoseStamped> &_poses, const std::string &_frame_id) {
+    // Skip the poses already received, a gap in the sequence means that older poses were dropped by the sender
+    size_t first = current_path_seq_ > _first_seq ? current_path_seq_ - _first_seq : 0;
+    if (first >= _poses.size()) return;
+    current_path_seq_ = _first_seq + _poses.size();
+    current_path_.header.frame_id = _frame_id;
+    trail_chunk_.header.frame_id = _frame_id;
+    int max_chunks = trail_capacity_ / (trail_chunk_size_ - 1) + 1;
+    for (size_t i = first; i < _poses.size(); i++) {
+        current_trail_.push(_poses[i]);
+        if (mission_log_.isOpen()) {
+            mission_log_.logCurrentPath(_poses[i].pose.position.x, _poses[i].pose.position.y, _poses[i].pose.position.z);
+        }
+        if (trail_chunk_.points.size() >= trail_chunk_size_) {
+            // Close the chunk and start the next one from its last point, chunks older than trail_capacity are deleted
+            pub_trail_.publish(trail_chunk_);
+            geometry_msgs::Point last_point = trail_chunk_.points.back();
+            trail_chunk_.points.assign(1, last_point);
+            trail_chunk_.id++;
+            if (trail_chunk_.id >= max_chunks) {
+                visualization_msgs::Marker delete_chunk = trail_chunk_;
+                delete_chunk.id = trail_chunk_.id - max_chunks;
+                delete_chunk.action = visualization_msgs::Marker::DELETE;
+                delete_chunk.points.clear();
+                pub_trail_.publish(delete_chunk);
+            }
+        }
+        trail_chunk_.points.push_back(_poses[i].pose.position);
+    }
+    trail_changed_ = current_path_changed_ = true;
+}
+
+void Visualization::resetCurrentPath() {
+    // Delete the trail chunks still shown, the next one starts again from id 0
+    int max_chunks = trail_capacity_ / (trail_chunk_size_ - 1) + 1;
+    visualization_msgs::Marker delete_chunk = trail_chunk_;
+    delete_chunk.action = visualization_msgs::Marker::DELETE;
+    delete_chunk.points.clear();
+    for (int id = std::max(0, trail_chunk_.id - max_chunks + 1); id <= trail_chunk_.id; id++) {
+        delete_chunk.id = id;
+        pub_trail_.publish(delete_chunk);
+    }
+    trail_chunk_.id = 0;
+    trail_chunk_.points.clear();
+    current_trail_.clear();
+    current_path_.poses.clear();
+    current_path_seq_ = 0;
+    trail_changed_ = current_path_changed_ = false;
+}
+
+nav_msgs::Path Visualization::decimatePath(const nav_msgs::Path &_path) {
+    // Level of detail: every n-th pose and the last one, at most max_path_points poses
+    if (max_path_points_ < 2 || _path.poses.size() <= max_path_points_) return _path;
+    nav_msgs::Path out_path;
+    out_path.header = _path.header;
+    size_t stride = (_path.poses.size() - 2) / (max_path_points_ - 1) + 1;
+    for (size_t i = 0; i < _path.poses.size() - 1; i += stride) out_path.poses.push_back(_path.poses[i]);
+    out_path.poses.push_back(_path.poses.back());
+
+    return out_path;
+}
+
 void Visualization::ualStateCallback(const uav_abstraction_layer::State &_ual_state) {
     ual_state_.state = _ual_state.state;
 }
@@ -93,97 +248,127 @@ visualization_msgs::Marker Visualization::readModel(std::string _model) {
     return model_;
 }
 
-int Visualization::calculateNormalDistance(Eigen::Vector3f _current_point, double _search_range, int _prev_normal_pos_on_path, nav_msgs::Path _path_search) {
-    std::vector<double> vec_distances;
-    int start_search_pos_on_path = calculateDistanceOnPath(_prev_normal_pos_on_path, -_search_range, _path_search);
-    int end_search_pos_on_path = calculateDistanceOnPath(_prev_normal_pos_on_path, _search_range, _path_search);
-    for (int i = start_search_pos_on_path; i < end_search_pos_on_path; i++) {
-        Eigen::Vector3f target_path_point;
-        target_path_point = Eigen::Vector3f(_path_search.poses.at(i).pose.position.x, _path_search.poses.at(i).pose.position.y, _path_search.poses.at(i).pose.position.z);
-        vec_distances.push_back((target_path_point - _current_point).norm());
-    }
-    auto smallest_distance = std::min_element(vec_distances.begin(), vec_distances.end());
-    int pos_on_path = smallest_distance - vec_distances.begin();
-    normal_distance_ = *smallest_distance;
-
-    return pos_on_path + start_search_pos_on_path;
-}
-
-int Visualization::calculateDistanceOnPath(int _prev_normal_pos_on_path, double _meters, nav_msgs::Path _path_search) {
-    int pos_equals_dist;
-    double dist_to_front, dist_to_back, temp_dist;
-    std::vector<double> vec_distances;
-    Eigen::Vector3f p_prev = Eigen::Vector3f(_path_search.poses.at(_prev_normal_pos_on_path).pose.position.x, _path_search.poses.at(_prev_normal_pos_on_path).pose.position.y, _path_search.poses.at(_prev_normal_pos_on_path).pose.position.z);
-    Eigen::Vector3f p_front = Eigen::Vector3f(_path_search.poses.front().pose.position.x, _path_search.poses.front().pose.position.y, _path_search.poses.front().pose.position.z);
-    Eigen::Vector3f p_back = Eigen::Vector3f(_path_search.poses.back().pose.position.x, _path_search.poses.back().pose.position.y, _path_search.poses.back().pose.position.z);
-    dist_to_front = (p_prev - p_front).norm();
-    dist_to_back = (p_prev - p_back).norm();
-    temp_dist = 0.0;
-    if (_meters > 0) {
-        if (_meters < dist_to_back) {
-            for (int i = _prev_normal_pos_on_path; i < _path_search.poses.size() - 1; i++) {
-                Eigen::Vector3f p1 = Eigen::Vector3f(_path_search.poses.at(i).pose.position.x, _path_search.poses.at(i).pose.position.y, _path_search.poses.at(i).pose.position.z);
-                Eigen::Vector3f p2 = Eigen::Vector3f(_path_search.poses.at(i + 1).pose.position.x, _path_search.poses.at(i + 1).pose.position.y, _path_search.poses.at(i + 1).pose.position.z);
-                temp_dist = temp_dist + (p2 - p1).norm();
-                if (temp_dist < _meters) {
-                    pos_equals_dist = i;
-                } else {
-                    i = _path_search.poses.size();
-                }
-            }
-        } else {
-            pos_equals_dist = _path_search.poses.size() - 1;
-        }
-    } else {
-        if (_meters < dist_to_front) {
-            pos_equals_dist = 0;
-            for (int i = _prev_normal_pos_on_path; i >= 1; i--) {
-                Eigen::Vector3f p1 = Eigen::Vector3f(_path_search.poses.at(i).pose.position.x, _path_search.poses.at(i).pose.position.y, _path_search.poses.at(i).pose.position.z);
-                Eigen::Vector3f p0 = Eigen::Vector3f(_path_search.poses.at(i - 1).pose.position.x, _path_search.poses.at(i - 1).pose.position.y, _path_search.poses.at(i - 1).pose.position.z);
-                temp_dist = temp_dist + (p1 - p0).norm();
-                if (temp_dist < fabs(_meters / 2)) {
-                    pos_equals_dist = i;
-                } else {
-                    i = 0;
-                }
-            }
-        } else {
-            pos_equals_dist = 0;
-        }
-    }
-
-    return pos_equals_dist;
-}
-
-void Visualization::saveMissionData() {
-    static double begin = ros::Time::now().toSec();
-    static bool flag_once = true;
-    if (flag_once) {
-        csv_normal_distances_ << std::fixed << std::setprecision(5);
+void Visualization::measureTracking() {
+    if (interp1_outdated_) {
         upat_follower::Generator generator(2.0, 3.0, 1.0, 0);
         interp1_path_ = generator.generatePath(init_path_, 0);
-        flag_once = false;
+        interp1_outdated_ = false;
     }
     Eigen::Vector3f current_point = Eigen::Vector3f(ual_pose_.pose.position.x, ual_pose_.pose.position.y, ual_pose_.pose.position.z);
-    csv_normal_distances_ << ros::Time::now().toSec() - begin << "," ;
+    double normal_dist_generated_path = std::numeric_limits<double>::quiet_NaN();
+    double normal_dist_init_path = std::numeric_limits<double>::quiet_NaN();
     if (generated_path_.poses.size() > 1) {
-        int normal_pos_on_generated_path = calculateNormalDistance(current_point, 2.0, prev_normal_pos_on_generated_path_, generated_path_);
-        normal_dist_generated_path_.push_back(normal_distance_);
-        prev_normal_pos_on_generated_path_ = normal_pos_on_generated_path;
-        csv_normal_distances_ << normal_distance_ << ",";
+        normal_dist_generated_path = normal_distance_generated_path_.calculate(current_point, generated_path_);
+        generated_path_stats_.add(normal_dist_generated_path);
+        if (!segment_stats_.empty()) segment_stats_[std::min<int>(closestSegment(current_point, init_path_), segment_stats_.size() - 1)].add(normal_dist_generated_path);
     }
     if (interp1_path_.poses.size() > 1) {
-        int normal_pos_on_init_path = calculateNormalDistance(current_point, 2.0, prev_normal_pos_on_init_path_, interp1_path_);
-        normal_dist_init_path_.push_back(normal_distance_);
-        csv_normal_distances_ << normal_distance_ << std::endl;
-        prev_normal_pos_on_init_path_ = normal_pos_on_init_path;
+        normal_dist_init_path = normal_distance_init_path_.calculate(current_point, interp1_path_);
+        init_path_stats_.add(normal_dist_init_path);
     }
+    if (save_experiment) saveMissionData(normal_dist_generated_path, normal_dist_init_path);
+}
+
+void Visualization::saveMissionData(double _normal_dist_generated_path, double _normal_dist_init_path) {
+    static double begin = ros::Time::now().toSec();
+    // Formatting and writing happen in the writer thread of the log
+    mission_log_.logNormalDistance(ros::Time::now().toSec() - begin, _normal_dist_generated_path, _normal_dist_init_path);
+}
+
+void Visualization::pubTrackingStats() {
+    upat_follower::TrackingStats msg;
+    msg.header.stamp = ros::Time::now();
+    msg.header.frame_id = init_path_.header.frame_id;
+    msg.generated_path = generated_path_stats_.toMsg();
+    msg.init_path = init_path_stats_.toMsg();
+    for (size_t i = 0; i < segment_stats_.size(); i++) msg.segments.push_back(segment_stats_[i].toMsg());
+    pub_tracking_stats_.publish(msg);
 }
 
 void Visualization::pubMsgs() {
-    pub_init_path_.publish(init_path_);
-    pub_generated_path_.publish(generated_path_);
-    pub_current_path_.publish(current_path_);
+    UPAT_TRACE_SCOPE("Visualization::pubMsgs");
+    if (paths_changed_) {
+        pub_init_path_.publish(decimatePath(init_path_));
+        pub_generated_path_.publish(decimatePath(generated_path_));
+        paths_changed_ = false;
+    }
+    if (trail_changed_) {
+        pub_trail_.publish(trail_chunk_);
+        trail_changed_ = false;
+    }
+    // The whole flight history as a path, throttled to current_path_rate
+    if (current_path_changed_ && current_path_rate_ > 0 && (ros::Time::now() - last_current_path_pub_).toSec() >= 1.0 / current_path_rate_) {
+        current_path_.poses.clear();
+        size_t stride = max_path_points_ > 1 ? (current_trail_.size() - 1) / (max_path_points_ - 1) + 1 : 1;
+        for (size_t i = 0; i < current_trail_.size() - 1; i += stride) current_path_.poses.push_back(current_trail_[i]);
+        current_path_.poses.push_back(current_trail_.back());
+        pub_current_path_.publish(current_path_);
+        last_current_path_pub_ = ros::Time::now();
+        current_path_changed_ = false;
+    }
     uav_model_.pose = ual_pose_.pose;
     pub_uav_model_.publish(uav_model_);
+}
+
+void Visualization::update() {
+    UPAT_TRACE_SCOPE("Visualization::update");
+    pubMsgs();
+    if (!current_trail_.empty()) {
+        if (ual_state_.state == 4) {
+            measureTracking();
+            if (do_once_) {
+                start_time_ = ros::Time::now().toSec();
+                do_once_ = false;
+            }
+        } else {
+            if (!do_once_) {
+                ROS_INFO("Time: %f", ros::Time::now().toSec() - start_time_);
+                do_once_ = true;
+            }
+        }
+    }
+    if (stats_rate_ > 0 && generated_path_stats_.count() > 0 && (ros::Time::now() - last_stats_pub_).toSec() >= 1.0 / stats_rate_) {
+        pubTrackingStats();
+        last_stats_pub_ = ros::Time::now();
+    }
+}
+
+void Visualization::openExperimentFiles(bool _trajectory, int _generator_mode) {
+    std::string pkg_name_path = ros::package::getPath("upat_follower");
+    auto t = std::time(nullptr);
+    auto tm = *std::localtime(&t);
+    std::ostringstream oss;
+    oss << std::put_time(&tm, "%Y-%m-%d_%H-%M-%S");
+    std::string folder_data_name = pkg_name_path + "/data/log/" + oss.str();
+    if (mkdir((folder_data_name).c_str(), 0777) == -1) ROS_WARN("Directory creation failed");
+    std::string normal_dist_csv, current_path_csv;
+    if (_trajectory) {
+        normal_dist_csv = "normal_dist_trajectory.csv";
+        current_path_csv = "current_trajectory.csv";
+    } else {
+        switch (_generator_mode) {
+            case 0:
+                normal_dist_csv = "normal_dist_linear_interp.csv";
+                current_path_csv = "current_path_linear_interp.csv";
+                break;
+            case 1:
+                normal_dist_csv = "normal_dist_cubic_loyal_spline.csv";
+                current_path_csv = "current_path_cubic_loyal_spline.csv";
+                break;
+            case 2:
+                normal_dist_csv = "normal_dist_cubic_spline.csv";
+                current_path_csv = "current_path_cubic_spline.csv";
+                break;
+        }
+    }
+    // Binary log, converted to the CSV files when the experiment is closed or by mission_log_converter after a crash
+    mission_log_file_ = folder_data_name + "/mission.log";
+    mission_log_.open(mission_log_file_, normal_dist_csv, current_path_csv, log_flush_period_);
+}
+
+void Visualization::closeExperimentFiles() {
+    // The flight history is logged as it arrives, see appendCurrentPath
+    if (!mission_log_.isOpen()) return;
+    mission_log_.close();
+    upat_follower::convertMissionLog(mission_log_file_);
 }
\ No newline at end of file
@@ -17,7 +17,6 @@
 // OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //----------------------------------------------------------------------------------------------------------------------
 
-#include <sys/stat.h>
 #include <upat_follower/visualization.h>
 
 int main(int _argc, char **_argv) {
@@ -32,67 +31,17 @@ int main(int _argc, char **_argv) {
     Visualization visual;
     visual.save_experiment = save_experiment_data;
     if (visual.save_experiment) {
-        std::string pkg_name_path = ros::package::getPath("upat_follower");
-        auto t = std::time(nullptr);
-        auto tm = *std::localtime(&t);
-        std::ostringstream oss;
-        oss << std::put_time(&tm, "%Y-%m-%d_%H-%M-%S");
-        std::string folder_data_name = pkg_name_path + "/data/log/" + oss.str();
-        if (mkdir((folder_data_name).c_str(), 0777) == -1) ROS_WARN("Directory creation failed");
-        if (trajectory) {
-            visual.csv_normal_distances_.open(folder_data_name + "/normal_dist_trajectory.csv");
-            visual.csv_current_path_.open(folder_data_name + "/current_trajectory.csv");
-        } else {
-            switch (generator_mode) {
-                case 0:
-                    visual.csv_normal_distances_.open(folder_data_name + "/normal_dist_linear_interp.csv");
-                    visual.csv_current_path_.open(folder_data_name + "/current_path_linear_interp.csv");
-                    break;
-                case 1:
-                    visual.csv_normal_distances_.open(folder_data_name + "/normal_dist_cubic_loyal_spline.csv");
-                    visual.csv_current_path_.open(folder_data_name + "/current_path_cubic_loyal_spline.csv");
-                    break;
-                case 2:
-                    visual.csv_normal_distances_.open(folder_data_name + "/normal_dist_cubic_spline.csv");
-                    visual.csv_current_path_.open(folder_data_name + "/current_path_cubic_spline.csv");
-                    break;
-            }
-        }
+        visual.openExperimentFiles(trajectory, generator_mode);
     }
-    double start_time;
-    bool do_once = true;
     ros::Rate rate(50);
     while (ros::ok()) {
-        visual.pubMsgs();
-        if (visual.current_path_.poses.size() > 0) {
-            if (visual.ual_state_.state == 4) {
-                if (visual.save_experiment == true) {
-                    visual.saveMissionData();
-                }
-                if (do_once) {
-                    start_time = ros::Time::now().toSec();
-                    do_once = false;
-                }
-            } else {
-                if (!do_once) {
-                    ROS_INFO("Time: %f", ros::Time::now().toSec() - start_time);
-                    do_once = true;
-                }
-            }
-        }
+        visual.update();
         ros::spinOnce();
         rate.sleep();
     }
 
     if (visual.save_experiment) {
-        for (int i = 0; visual.current_path_.poses.size(); i++) {
-            visual.csv_current_path_
-                << visual.current_path_.poses.at(i).pose.position.x << ", "
-                << visual.current_path_.poses.at(i).pose.position.y << ", "
-                << visual.current_path_.poses.at(i).pose.position.z << std::endl;
-        }
-        visual.csv_normal_distances_.close();
-        visual.csv_current_path_.close();
+        visual.closeExperimentFiles();
     }
 
     return 0;
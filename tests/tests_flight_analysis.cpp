@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <upat_follower/flight_analysis.h>
+#include <cmath>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+
+nav_msgs::Path linePath(double _x_end, double _step, double _y) {
+    nav_msgs::Path path;
+    for (int i = 0; i * _step <= _x_end + 1e-9; i++) {
+        geometry_msgs::PoseStamped pose;
+        pose.pose.position.x = i * _step;
+        pose.pose.position.y = _y;
+        path.poses.push_back(pose);
+    }
+    return path;
+}
+
+TEST(FlightAnalysisTestSuite, crossTrackErrorIsPerpendicular) {
+    // Reference poses 2 m apart: the closest pose is up to 1 m away along the path, the segment is 0.5 m away
+    nav_msgs::Path reference = linePath(10.0, 2.0, 0.0);
+    Eigen::Vector3f point(3.0, 0.5, 0.0);
+    EXPECT_NEAR(0.5, upat_follower::crossTrackError(point, reference, 1), 1e-6);
+    EXPECT_NEAR(0.5, upat_follower::crossTrackError(point, reference, 2), 1e-6);
+}
+
+TEST(FlightAnalysisTestSuite, parallelFlight) {
+    nav_msgs::Path reference = linePath(10.0, 0.4, 0.0);
+    nav_msgs::Path flight = linePath(10.0, 0.5, 0.3);
+    std::vector<double> times = {0.0, 0.02, 12.5};
+    upat_follower::FlightMetrics metrics = upat_follower::analyseFlight(flight, reference, times);
+    EXPECT_EQ(21, metrics.samples);
+    EXPECT_TRUE(metrics.completed);
+    EXPECT_DOUBLE_EQ(12.5, metrics.completion_time);
+    EXPECT_NEAR(0.3, metrics.mean_cross_track, 1e-6);
+    EXPECT_NEAR(0.3, metrics.max_cross_track, 1e-6);
+    EXPECT_GT(metrics.mean_normal_distance, metrics.mean_cross_track);
+    // Distance to the closest pose found by the search window, up to one reference step along the path
+    EXPECT_LE(metrics.max_normal_distance, std::sqrt(0.4 * 0.4 + 0.3 * 0.3) + 1e-6);
+}
+
+TEST(FlightAnalysisTestSuite, unfinishedFlight) {
+    upat_follower::FlightMetrics metrics = upat_follower::analyseFlight(linePath(5.0, 0.5, 0.0), linePath(10.0, 0.4, 0.0), std::vector<double>());
+    EXPECT_FALSE(metrics.completed);
+    EXPECT_LT(metrics.completion_time, 0.0);
+    EXPECT_NEAR(0.0, metrics.max_cross_track, 1e-6);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <ros/package.h>
+#include <ros/ros.h>
+#include <upat_follower/follower.h>
+#include <upat_follower/mission_io.h>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+
+class FollowerTestSuite : public ::testing::Test {
+   public:
+    FollowerTestSuite() {
+    }
+    ~FollowerTestSuite() {}
+};
+
+// One pose every _spacing meters along x
+nav_msgs::Path straightPath(int _size, double _spacing) {
+    nav_msgs::Path path;
+    path.header.frame_id = "map";
+    path.poses.resize(_size);
+    for (int i = 0; i < _size; i++) {
+        path.poses.at(i).pose.position.x = i * _spacing;
+        path.poses.at(i).pose.orientation.w = 1.0;
+    }
+    return path;
+}
+
+geometry_msgs::PoseStamped poseAt(double _x) {
+    geometry_msgs::PoseStamped pose;
+    pose.pose.position.x = _x;
+    pose.pose.orientation.w = 1.0;
+    return pose;
+}
+
+TEST_F(FollowerTestSuite, sparsePathSearchWindow) {
+    // Poses further apart than the search range, the window must still stay around the UAV
+    upat_follower::Follower follower(1);
+    follower.loadPath(straightPath(41, 1.0), 1.2, 1.0);
+    double x = 0.0;
+    for (int tick = 0; tick < 600; tick++) {
+        // Fly at 1.5 m/s for 20 m, then hover
+        if (tick < 400) x = tick * 0.05;
+        follower.updatePose(poseAt(x));
+        follower.getVelocity();
+        std::pair<int, int> window = follower.getSearchWindow();
+        int closest = std::round(x);
+        EXPECT_LE(window.first, closest) << "tick " << tick;
+        EXPECT_GE(window.second, closest) << "tick " << tick;
+        EXPECT_LE(window.second - window.first, 4) << "tick " << tick;
+    }
+}
+
+TEST_F(FollowerTestSuite, densePathSearchWindow) {
+    upat_follower::Follower follower(1);
+    follower.loadPath(straightPath(2001, 0.01), 1.2, 1.0);
+    double x = 0.0;
+    for (int tick = 0; tick < 300; tick++) {
+        if (tick < 200) x = tick * 0.05;
+        follower.updatePose(poseAt(x));
+        follower.getVelocity();
+        std::pair<int, int> window = follower.getSearchWindow();
+        int closest = std::round(x / 0.01);
+        EXPECT_LE(window.first, closest) << "tick " << tick;
+        EXPECT_GE(window.second, closest) << "tick " << tick;
+        // About 0.6 m forward and 0.3 m backward at this speed, never the whole path
+        EXPECT_LE(window.second - window.first, 120) << "tick " << tick;
+    }
+}
+
+// Every look ahead point of the table must be the one searched along the path
+void expectLookAheadTable(upat_follower::Follower &_follower, int _size) {
+    for (int i = 0; i < _size; i++) {
+        int searched = _follower.getPosLookAhead(i, false);
+        EXPECT_EQ(_follower.getPosLookAhead(i), searched) << "pos " << i;
+    }
+}
+
+TEST_F(FollowerTestSuite, lookAheadTable) {
+    nav_msgs::Path trajectory = upat_follower::csvToPath(ros::package::getPath("upat_follower") + "/tests/splines/trajectory.csv");
+    ASSERT_GT(trajectory.poses.size(), 2);
+    std::vector<double> speed_percentages(trajectory.poses.size());
+    for (int i = 0; i < speed_percentages.size(); i++) {
+        speed_percentages[i] = 0.4 + 0.6 * i / speed_percentages.size();
+    }
+    upat_follower::Follower follower(1);
+    follower.loadTrajectory(trajectory, speed_percentages, 2.0);
+    expectLookAheadTable(follower, trajectory.poses.size());
+}
+
+TEST_F(FollowerTestSuite, lookAheadTableShrinking) {
+    // Velocity percentage dropping by steps, the look ahead point has to walk back along the path
+    nav_msgs::Path trajectory = upat_follower::csvToPath(ros::package::getPath("upat_follower") + "/tests/splines/trajectory.csv");
+    ASSERT_GT(trajectory.poses.size(), 2);
+    std::vector<double> speed_percentages(trajectory.poses.size());
+    for (int i = 0; i < speed_percentages.size(); i++) {
+        speed_percentages[i] = 1.0 - 0.3 * ((i / 100) % 4);
+    }
+    upat_follower::Follower follower(1);
+    follower.loadTrajectory(trajectory, speed_percentages, 2.0);
+    expectLookAheadTable(follower, trajectory.poses.size());
+    // The look ahead point really moves back where the percentage drops
+    int drops = 0;
+    for (int i = 1; i < speed_percentages.size(); i++) {
+        if (follower.getPosLookAhead(i) < follower.getPosLookAhead(i - 1)) drops++;
+    }
+    EXPECT_GT(drops, 0);
+}
+
+int main(int argc, char** argv) {
+    ros::init(argc, argv, "tests_follower", ros::init_options::AnonymousName | ros::init_options::NoRosout | ros::init_options::NoSigintHandler);
+    ros::Time::init();
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
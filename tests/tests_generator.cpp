@@ -3,6 +3,7 @@
 #include <ros/package.h>
 #include <ros/ros.h>
 #include <upat_follower/generator.h>
+#include <upat_follower/mission_io.h>
 #include <fstream>
 #include <string>
 #include <thread>
@@ -17,52 +18,8 @@ class MyTestSuite : public ::testing::Test {
     float tolerance = 0.0001;
 };
 
-nav_msgs::Path constructPath(std::vector<double> wps_x, std::vector<double> wps_y, std::vector<double> wps_z) {
-    nav_msgs::Path path_msg;
-    std::vector<geometry_msgs::PoseStamped> poses(wps_x.size());
-    for (int i = 0; i < wps_x.size(); i++) {
-        poses.at(i).pose.position.x = wps_x[i];
-        poses.at(i).pose.position.y = wps_y[i];
-        poses.at(i).pose.position.z = wps_z[i];
-        poses.at(i).pose.orientation.x = 0;
-        poses.at(i).pose.orientation.y = 0;
-        poses.at(i).pose.orientation.z = 0;
-        poses.at(i).pose.orientation.w = 1;
-    }
-    path_msg.poses = poses;
-    return path_msg;
-}
-
 nav_msgs::Path csvToPath(std::string file_name) {
-    nav_msgs::Path out_path;
-    std::string pkg_name_path = ros::package::getPath("upat_follower");
-    std::string folder_name = pkg_name_path + "/tests/splines" + file_name;
-    std::fstream read_csv;
-    read_csv.open(folder_name);
-    std::vector<double> list_x, list_y, list_z;
-    if (read_csv.is_open()) {
-        while (read_csv.good()) {
-            std::string x, y, z;
-            double dx, dy, dz;
-            getline(read_csv, x, ',');
-            getline(read_csv, y, ',');
-            getline(read_csv, z, '\n');
-            std::stringstream sx(x);
-            std::stringstream sy(y);
-            std::stringstream sz(z);
-            sx >> dx;
-            sy >> dy;
-            sz >> dz;
-            list_x.push_back(dx);
-            list_y.push_back(dy);
-            list_z.push_back(dz);
-        }
-        list_x.pop_back();
-        list_y.pop_back();
-        list_z.pop_back();
-    }
-
-    return constructPath(list_x, list_y, list_z);
+    return upat_follower::csvToPath(ros::package::getPath("upat_follower") + "/tests/splines" + file_name);
 }
 
 TEST_F(MyTestSuite, interp1) {
@@ -104,6 +61,60 @@ TEST_F(MyTestSuite, cubicSpline) {
     }
 }
 
+TEST_F(MyTestSuite, trajectoryCancelled) {
+    upat_follower::Generator generator_(2.0, 3.0, 1.0);
+    nav_msgs::Path init_path = csvToPath("/init.csv");
+    std::vector<double> times(init_path.poses.size() - 1, 1.0);
+    int calls = 0;
+    upat_follower::GeneratorResult result = generator_.generateTrajectory(init_path, times, [&](int _iteration, int _num_joints, double _max_vel, double _spline_max_vel) {
+        EXPECT_EQ(_iteration, 0);
+        EXPECT_GE(_num_joints, init_path.poses.size());
+        calls++;
+        return false;
+    });
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(result.generated_path.poses.empty());
+    EXPECT_TRUE(result.generated_path_vel_percentage.poses.empty());
+}
+
+TEST_F(MyTestSuite, trajectoryRepeated) {
+    upat_follower::Generator generator_(2.0, 3.0, 1.0);
+    upat_follower::GeneratorWorkspace workspace;
+    nav_msgs::Path init_path = csvToPath("/init.csv");
+    std::vector<double> times(init_path.poses.size() - 1, 1.0);
+    upat_follower::GeneratorResult first = generator_.generateTrajectory(init_path, times, workspace);
+    upat_follower::GeneratorResult second = generator_.generateTrajectory(init_path, times, workspace);
+    ASSERT_FALSE(first.generated_path.poses.empty());
+    EXPECT_EQ(first.generated_path.poses.size(), first.generated_times.size());
+    EXPECT_EQ(first.generated_times.size(), second.generated_times.size());
+    EXPECT_EQ(first.max_velocity, second.max_velocity);
+}
+
+TEST_F(MyTestSuite, concurrentPaths) {
+    upat_follower::Generator generator_(2.0, 3.0, 1.0);
+    nav_msgs::Path init_path = csvToPath("/init.csv");
+    nav_msgs::Path ref_paths[3];
+    for (int mode = 0; mode < 3; mode++) ref_paths[mode] = generator_.generatePath(init_path, mode);
+    std::vector<nav_msgs::Path> act_paths(12);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < act_paths.size(); i++) {
+        threads.push_back(std::thread([&, i] {
+            upat_follower::GeneratorWorkspace workspace;
+            for (int j = 0; j < 4; j++) act_paths[i] = generator_.generatePath(init_path, i % 3, workspace).generated_path;
+        }));
+    }
+    for (int i = 0; i < threads.size(); i++) threads[i].join();
+    for (int i = 0; i < act_paths.size(); i++) {
+        const nav_msgs::Path &ref_path = ref_paths[i % 3];
+        ASSERT_EQ(ref_path.poses.size(), act_paths[i].poses.size());
+        for (int j = 0; j < ref_path.poses.size(); j++) {
+            EXPECT_EQ(ref_path.poses.at(j).pose.position.x, act_paths[i].poses.at(j).pose.position.x);
+            EXPECT_EQ(ref_path.poses.at(j).pose.position.y, act_paths[i].poses.at(j).pose.position.y);
+            EXPECT_EQ(ref_path.poses.at(j).pose.position.z, act_paths[i].poses.at(j).pose.position.z);
+        }
+    }
+}
+
 int main(int argc, char** argv) {
     ros::init(argc, argv, "tests_node");
     ros::NodeHandle nh;
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <upat_follower/mission_io.h>
+#include <fstream>
+#include <string>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+
+class MissionIOTestSuite : public ::testing::Test {
+   public:
+    MissionIOTestSuite() {
+    }
+    ~MissionIOTestSuite() {}
+    std::string writeFile(std::string content) {
+        std::string file_name = "/tmp/upat_follower_tests_mission_io.csv";
+        std::ofstream csv(file_name);
+        csv << content;
+        return file_name;
+    }
+};
+
+TEST_F(MissionIOTestSuite, waypoints) {
+    nav_msgs::Path path = upat_follower::csvToPath(writeFile("5.00000,  -2.50000, 12.50000\n-5,5.25,1e1\n"), "uav_1_home");
+    ASSERT_EQ(2, path.poses.size());
+    EXPECT_EQ("uav_1_home", path.header.frame_id);
+    EXPECT_DOUBLE_EQ(-2.5, path.poses.at(0).pose.position.y);
+    EXPECT_DOUBLE_EQ(-5.0, path.poses.at(1).pose.position.x);
+    EXPECT_DOUBLE_EQ(5.25, path.poses.at(1).pose.position.y);
+    EXPECT_DOUBLE_EQ(10.0, path.poses.at(1).pose.position.z);
+    EXPECT_DOUBLE_EQ(1.0, path.poses.at(1).pose.orientation.w);
+}
+
+TEST_F(MissionIOTestSuite, headersCommentsAndEmptyLines) {
+    nav_msgs::Path path = upat_follower::csvToPath(writeFile("x, y, z\r\n# takeoff\r\n1, 2, 3 # first\r\n\r\n4\t5\t6\r\n\n"));
+    ASSERT_EQ(2, path.poses.size());
+    EXPECT_DOUBLE_EQ(3.0, path.poses.at(0).pose.position.z);
+    EXPECT_DOUBLE_EQ(4.0, path.poses.at(1).pose.position.x);
+}
+
+TEST_F(MissionIOTestSuite, sameValuesAsStrtod) {
+    std::string numbers[] = {"0.1", "-0.00001", "123456.789012", "3.141592653589793", "1234567890123456789", "-1.5e-3", "0.30000000000000004"};
+    for (auto &number : numbers) {
+        std::vector<double> values = upat_follower::csvToVector(writeFile(number + "\n"));
+        ASSERT_EQ(1, values.size());
+        EXPECT_EQ(std::strtod(number.c_str(), nullptr), values.at(0)) << number;
+    }
+}
+
+TEST_F(MissionIOTestSuite, errors) {
+    std::vector<double> values;
+    EXPECT_FALSE(upat_follower::readCsv(writeFile("1, 2, 3\n4, 5\n"), 3, values));
+    EXPECT_TRUE(values.empty());
+    EXPECT_FALSE(upat_follower::readCsv(writeFile("1, 2, 3\n4, five, 6\n"), 3, values));
+    EXPECT_FALSE(upat_follower::readCsv("/tmp/upat_follower_tests_missing.csv", 3, values));
+    EXPECT_TRUE(upat_follower::readCsv(writeFile(""), 3, values));
+    EXPECT_TRUE(values.empty());
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <upat_follower/mission_log.h>
+#include <upat_follower/spsc_queue.h>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+
+std::string readFile(const std::string &_file_name) {
+    std::ifstream file(_file_name);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+TEST(SpscQueueTestSuite, fullQueueRejectsItems) {
+    upat_follower::SpscQueue<int> queue(3);
+    ASSERT_EQ(4, queue.capacity());
+    for (int i = 0; i < 4; i++) EXPECT_TRUE(queue.tryPush(i));
+    EXPECT_FALSE(queue.tryPush(4));
+    int item;
+    ASSERT_TRUE(queue.tryPop(item));
+    EXPECT_EQ(0, item);
+    EXPECT_TRUE(queue.tryPush(4));
+}
+
+TEST(SpscQueueTestSuite, itemsArriveInOrderAcrossThreads) {
+    upat_follower::SpscQueue<int> queue(64);
+    const int count = 200000;
+    std::thread producer([&queue, count]() {
+        for (int i = 0; i < count; i++) {
+            while (!queue.tryPush(i)) std::this_thread::yield();
+        }
+    });
+    int expected = 0, item;
+    while (expected < count) {
+        if (queue.tryPop(item)) {
+            ASSERT_EQ(expected, item);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MissionLogTestSuite, convertsToFormerCsvLayout) {
+    upat_follower::MissionLog log;
+    ASSERT_TRUE(log.open("/tmp/upat_follower_tests_mission.log", "upat_follower_tests_normal_dist.csv", "upat_follower_tests_current_path.csv"));
+    EXPECT_TRUE(log.logNormalDistance(0.02, 0.123456, 1.5));
+    EXPECT_TRUE(log.logCurrentPath(1.5, -2.25, 10.0));
+    EXPECT_TRUE(log.logNormalDistance(0.04, std::numeric_limits<double>::quiet_NaN(), 2.0));
+    EXPECT_TRUE(log.logCurrentPath(0.1234567, 0, 3));
+    log.close();
+    ASSERT_TRUE(upat_follower::convertMissionLog("/tmp/upat_follower_tests_mission.log"));
+    EXPECT_EQ("0.02000,0.12346,1.50000\n0.04000,2.00000\n", readFile("/tmp/upat_follower_tests_normal_dist.csv"));
+    EXPECT_EQ("1.5, -2.25, 10\n0.123457, 0, 3\n", readFile("/tmp/upat_follower_tests_current_path.csv"));
+}
+
+TEST(MissionLogTestSuite, truncatedLogKeepsWholeRecords) {
+    upat_follower::MissionLog log;
+    ASSERT_TRUE(log.open("/tmp/upat_follower_tests_mission.log", "upat_follower_tests_normal_dist.csv", "upat_follower_tests_current_path.csv"));
+    for (int i = 0; i < 3; i++) log.logCurrentPath(i, i, i);
+    log.close();
+    // Cut the last record in half, as a crash in the middle of a write
+    std::string content = readFile("/tmp/upat_follower_tests_mission.log");
+    std::ofstream truncated("/tmp/upat_follower_tests_mission.log", std::ios::binary);
+    truncated << content.substr(0, content.size() - sizeof(upat_follower::MissionLogRecord) / 2);
+    truncated.close();
+    ASSERT_TRUE(upat_follower::convertMissionLog("/tmp/upat_follower_tests_mission.log"));
+    EXPECT_EQ("0, 0, 0\n1, 1, 1\n", readFile("/tmp/upat_follower_tests_current_path.csv"));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
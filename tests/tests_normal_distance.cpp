@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <upat_follower/normal_distance.h>
+#include <cmath>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+
+class NormalDistanceTestSuite : public ::testing::Test {
+   public:
+    NormalDistanceTestSuite() {
+    }
+    ~NormalDistanceTestSuite() {}
+    float tolerance = 0.0001;
+};
+
+// One pose every _spacing meters along x
+nav_msgs::Path straightPath(int _size, double _spacing) {
+    nav_msgs::Path path;
+    path.header.frame_id = "map";
+    path.poses.resize(_size);
+    for (int i = 0; i < _size; i++) {
+        path.poses.at(i).pose.position.x = i * _spacing;
+        path.poses.at(i).pose.orientation.w = 1.0;
+    }
+    return path;
+}
+
+TEST_F(NormalDistanceTestSuite, sparsePathSearchWindow) {
+    // Poses further apart than the search range, the closest one must still be found from the first pose on
+    nav_msgs::Path path = straightPath(11, 3.0);
+    upat_follower::NormalDistance normal_distance(2.0);
+    for (int tick = 0; tick <= 600; tick++) {
+        double x = 0.01 + tick * 0.05;  // Never halfway between two poses
+        int closest = std::round(x / 3.0);
+        double expected = Eigen::Vector2f(x - closest * 3.0, 0.5).norm();
+        EXPECT_NEAR(normal_distance.calculate(Eigen::Vector3f(x, 0.5, 0.0), path), expected, tolerance) << "tick " << tick;
+        EXPECT_EQ(normal_distance.normal_pos_on_path_, closest) << "tick " << tick;
+    }
+}
+
+TEST_F(NormalDistanceTestSuite, sparsePathBackwards) {
+    nav_msgs::Path path = straightPath(11, 3.0);
+    upat_follower::NormalDistance normal_distance(2.0);
+    // Fly to the end of the path and come back along it
+    for (int tick = 0; tick <= 600; tick++) {
+        normal_distance.calculate(Eigen::Vector3f(tick * 0.05, 0.0, 1.0), path);
+    }
+    ASSERT_EQ(normal_distance.normal_pos_on_path_, 10);
+    for (int tick = 0; tick <= 600; tick++) {
+        double x = 29.99 - tick * 0.05;
+        int closest = std::round(x / 3.0);
+        EXPECT_NEAR(normal_distance.calculate(Eigen::Vector3f(x, 0.0, 1.0), path), Eigen::Vector2f(x - closest * 3.0, 1.0).norm(), tolerance) << "tick " << tick;
+    }
+}
+
+TEST_F(NormalDistanceTestSuite, densePath) {
+    nav_msgs::Path path = straightPath(2001, 0.01);
+    upat_follower::NormalDistance normal_distance(2.0);
+    for (int tick = 0; tick <= 400; tick++) {
+        double x = tick * 0.05;
+        EXPECT_NEAR(normal_distance.calculate(Eigen::Vector3f(x, -0.2, 0.0), path), 0.2, tolerance) << "tick " << tick;
+        EXPECT_EQ(normal_distance.normal_pos_on_path_, std::round(x / 0.01)) << "tick " << tick;
+    }
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <upat_follower/follower.h>
+#include <upat_follower/path_cache.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+
+class PathCacheTestSuite : public ::testing::Test {
+   public:
+    PathCacheTestSuite() {
+    }
+    ~PathCacheTestSuite() {
+        std::remove(file_name.c_str());
+        upat_follower::removeSharedPathCache(shared_name);
+    }
+    std::string file_name = "/tmp/upat_follower_tests_path.cache";
+    std::string shared_name = "/upat_follower_tests_path_cache";
+};
+
+nav_msgs::Path helix(int _points) {
+    nav_msgs::Path path;
+    path.header.frame_id = "uav_1_home";
+    path.poses.resize(_points);
+    for (int i = 0; i < _points; i++) {
+        double t = i * 0.05;
+        path.poses[i].pose.position.x = 10.0 * std::cos(t);
+        path.poses[i].pose.position.y = 10.0 * std::sin(t);
+        path.poses[i].pose.position.z = 5.0 + 0.1 * t;
+        path.poses[i].pose.orientation.w = 1.0;
+    }
+    return path;
+}
+
+upat_follower::PathCache trajectoryCache(int _points) {
+    upat_follower::PathCache cache;
+    cache.generator_mode_ = upat_follower::PathCache::trajectory_mode_;
+    cache.vxy_ = 2.0;
+    cache.vz_up_ = 3.0;
+    cache.vz_dn_ = 4.0;
+    cache.max_velocity_ = 1.5;
+    cache.hash_ = 0x0123456789abcdefULL;
+    cache.path_ = helix(_points);
+    for (int i = 0; i < _points; i++) cache.speed_.push_back(0.2 + 0.8 * i / _points);
+    return cache;
+}
+
+void expectSameCache(const upat_follower::PathCache &_expected, const upat_follower::PathCache &_actual) {
+    EXPECT_EQ(_expected.generator_mode_, _actual.generator_mode_);
+    EXPECT_EQ(_expected.vxy_, _actual.vxy_);
+    EXPECT_EQ(_expected.vz_up_, _actual.vz_up_);
+    EXPECT_EQ(_expected.vz_dn_, _actual.vz_dn_);
+    EXPECT_EQ(_expected.max_velocity_, _actual.max_velocity_);
+    EXPECT_EQ(_expected.hash_, _actual.hash_);
+    EXPECT_EQ(_expected.path_.header.frame_id, _actual.path_.header.frame_id);
+    ASSERT_EQ(_expected.path_.poses.size(), _actual.path_.poses.size());
+    for (int i = 0; i < _expected.path_.poses.size(); i++) {
+        EXPECT_EQ(_expected.path_.poses[i].pose.position.x, _actual.path_.poses[i].pose.position.x);
+        EXPECT_EQ(_expected.path_.poses[i].pose.position.y, _actual.path_.poses[i].pose.position.y);
+        EXPECT_EQ(_expected.path_.poses[i].pose.position.z, _actual.path_.poses[i].pose.position.z);
+    }
+    EXPECT_EQ(_expected.speed_, _actual.speed_);
+    // Arc length is always stored, computed from the path when the cache has none
+    ASSERT_EQ(_expected.path_.poses.size(), _actual.arc_length_.size());
+    double arc_length = 0.0;
+    for (int i = 1; i < _expected.path_.poses.size(); i++) {
+        const geometry_msgs::Point &p0 = _expected.path_.poses[i - 1].pose.position;
+        const geometry_msgs::Point &p1 = _expected.path_.poses[i].pose.position;
+        arc_length += std::sqrt((p1.x - p0.x) * (p1.x - p0.x) + (p1.y - p0.y) * (p1.y - p0.y) + (p1.z - p0.z) * (p1.z - p0.z));
+        EXPECT_NEAR(arc_length, _actual.arc_length_[i], 1e-9);
+    }
+}
+
+// Overwrite _size bytes of the file at _offset
+void patchFile(const std::string &_file_name, size_t _offset, const void *_data, size_t _size) {
+    std::fstream file(_file_name, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(_offset);
+    file.write(static_cast<const char *>(_data), _size);
+}
+
+TEST_F(PathCacheTestSuite, pathRoundTrip) {
+    upat_follower::PathCache cache;
+    cache.generator_mode_ = 2;
+    cache.vxy_ = 2.0;
+    cache.vz_up_ = 3.0;
+    cache.vz_dn_ = 1.0;
+    cache.hash_ = 42;
+    cache.path_ = helix(500);
+    ASSERT_TRUE(upat_follower::savePathCache(file_name, cache));
+    upat_follower::PathCache loaded;
+    ASSERT_TRUE(upat_follower::loadPathCache(file_name, loaded));
+    expectSameCache(cache, loaded);
+    EXPECT_TRUE(loaded.speed_.empty());
+}
+
+TEST_F(PathCacheTestSuite, trajectoryRoundTrip) {
+    upat_follower::PathCache cache = trajectoryCache(500);
+    ASSERT_TRUE(upat_follower::savePathCache(file_name, cache));
+    upat_follower::PathCache loaded;
+    ASSERT_TRUE(upat_follower::loadPathCache(file_name, loaded));
+    expectSameCache(cache, loaded);
+    upat_follower::MappedPathCache mapped;
+    ASSERT_TRUE(mapped.open(file_name));
+    EXPECT_EQ(500, mapped.header().size_);
+    ASSERT_NE(nullptr, mapped.speed());
+    EXPECT_EQ(cache.speed_.back(), mapped.speed()[499]);
+}
+
+TEST_F(PathCacheTestSuite, rejectsTruncatedFile) {
+    ASSERT_TRUE(upat_follower::savePathCache(file_name, trajectoryCache(100)));
+    std::ifstream in(file_name, std::ios::binary | std::ios::ate);
+    long size = in.tellg();
+    in.close();
+    ASSERT_EQ(0, truncate(file_name.c_str(), size - sizeof(double)));
+    upat_follower::PathCache loaded;
+    EXPECT_FALSE(upat_follower::loadPathCache(file_name, loaded));
+    // Not even a whole header
+    ASSERT_EQ(0, truncate(file_name.c_str(), sizeof(upat_follower::PathCacheHeader) / 2));
+    EXPECT_FALSE(upat_follower::loadPathCache(file_name, loaded));
+    EXPECT_FALSE(upat_follower::loadPathCache("/tmp/upat_follower_tests_missing.cache", loaded));
+}
+
+TEST_F(PathCacheTestSuite, rejectsWrongMagicAndVersion) {
+    upat_follower::PathCache loaded;
+    ASSERT_TRUE(upat_follower::savePathCache(file_name, trajectoryCache(100)));
+    char magic[8] = {'N', 'O', 'T', 'A', 'P', 'A', 'T', 'H'};
+    patchFile(file_name, offsetof(upat_follower::PathCacheHeader, magic_), magic, sizeof(magic));
+    EXPECT_FALSE(upat_follower::loadPathCache(file_name, loaded));
+
+    ASSERT_TRUE(upat_follower::savePathCache(file_name, trajectoryCache(100)));
+    uint32_t version = 2;
+    patchFile(file_name, offsetof(upat_follower::PathCacheHeader, version_), &version, sizeof(version));
+    EXPECT_FALSE(upat_follower::loadPathCache(file_name, loaded));
+}
+
+TEST_F(PathCacheTestSuite, hashMission) {
+    nav_msgs::Path init_path = helix(8);
+    std::vector<double> times = {0, 1, 2, 3, 4, 5, 6, 7};
+    uint64_t hash = upat_follower::hashMission(init_path, times, 1);
+    EXPECT_EQ(hash, upat_follower::hashMission(init_path, times, 1));
+    EXPECT_NE(hash, upat_follower::hashMission(init_path, times, 2));
+    std::vector<double> other_times = times;
+    other_times[3] = 3.5;
+    EXPECT_NE(hash, upat_follower::hashMission(init_path, other_times, 1));
+    EXPECT_NE(hash, upat_follower::hashMission(init_path, std::vector<double>(), 1));
+    nav_msgs::Path other_path = init_path;
+    other_path.poses[4].pose.position.z += 0.01;
+    EXPECT_NE(hash, upat_follower::hashMission(other_path, times, 1));
+}
+
+TEST_F(PathCacheTestSuite, followerRejectsOtherLimits) {
+    upat_follower::Follower follower(1);
+    follower.loadPath(helix(200), 1.2, 1.0);
+    upat_follower::PathCache cache = follower.getPathCache();
+    upat_follower::Follower other_follower(1);
+    EXPECT_TRUE(other_follower.loadPathCache(cache));
+    cache.vxy_ += 0.5;
+    EXPECT_FALSE(other_follower.loadPathCache(cache));
+    cache = follower.getPathCache();
+    cache.vz_dn_ += 0.5;
+    EXPECT_FALSE(other_follower.loadPathCache(cache));
+    // Trajectories without a velocity percentage per pose are rejected too
+    cache = follower.getPathCache();
+    cache.generator_mode_ = upat_follower::PathCache::trajectory_mode_;
+    EXPECT_FALSE(other_follower.loadPathCache(cache));
+}
+
+TEST_F(PathCacheTestSuite, sharedRoundTrip) {
+    upat_follower::PathCache cache = trajectoryCache(500);
+    ASSERT_TRUE(upat_follower::writeSharedPathCache(shared_name, cache));
+    upat_follower::PathCache loaded;
+    ASSERT_TRUE(upat_follower::loadSharedPathCache(shared_name, loaded));
+    expectSameCache(cache, loaded);
+    // A reader that mapped the previous segment keeps it when the path is written again
+    upat_follower::MappedPathCache mapped;
+    ASSERT_TRUE(mapped.openShared(shared_name));
+    upat_follower::removeSharedPathCache(shared_name);
+    ASSERT_TRUE(upat_follower::writeSharedPathCache(shared_name, trajectoryCache(20)));
+    EXPECT_EQ(500, mapped.header().size_);
+    EXPECT_EQ(cache.path_.poses[499].pose.position.x, mapped.x()[499]);
+    ASSERT_TRUE(upat_follower::loadSharedPathCache(shared_name, loaded));
+    EXPECT_EQ(20, loaded.path_.poses.size());
+    upat_follower::removeSharedPathCache(shared_name);
+    EXPECT_FALSE(upat_follower::loadSharedPathCache(shared_name, loaded));
+}
+
+TEST_F(PathCacheTestSuite, sharedRejectsWrongMagic) {
+    // A segment that is not a path cache, such as one still being written
+    int fd = shm_open(shared_name.c_str(), O_CREAT | O_RDWR, 0644);
+    ASSERT_NE(-1, fd);
+    ASSERT_EQ(0, ftruncate(fd, sizeof(upat_follower::PathCacheHeader) + 3 * sizeof(double)));
+    close(fd);
+    upat_follower::PathCache loaded;
+    EXPECT_FALSE(upat_follower::loadSharedPathCache(shared_name, loaded));
+}
+
+int main(int argc, char** argv) {
+    ros::init(argc, argv, "tests_path_cache", ros::init_options::AnonymousName | ros::init_options::NoRosout | ros::init_options::NoSigintHandler);
+    ros::Time::init();
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
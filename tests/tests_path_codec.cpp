@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <upat_follower/path_codec.h>
+#include <cmath>
+#include <random>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+
+nav_msgs::Path helix(int _points) {
+    nav_msgs::Path path;
+    path.header.frame_id = "map";
+    path.poses.resize(_points);
+    for (int i = 0; i < _points; i++) {
+        double t = i * 0.01;
+        path.poses[i].pose.position.x = 20.0 * std::cos(t);
+        path.poses[i].pose.position.y = 20.0 * std::sin(t);
+        path.poses[i].pose.position.z = 5.0 + 0.1 * t;
+        path.poses[i].pose.orientation.w = 1;
+    }
+    return path;
+}
+
+void expectNear(const nav_msgs::Path &_expected, const nav_msgs::Path &_path, double _tolerance) {
+    ASSERT_EQ(_expected.poses.size(), _path.poses.size());
+    for (size_t i = 0; i < _path.poses.size(); i++) {
+        EXPECT_NEAR(_expected.poses[i].pose.position.x, _path.poses[i].pose.position.x, _tolerance);
+        EXPECT_NEAR(_expected.poses[i].pose.position.y, _path.poses[i].pose.position.y, _tolerance);
+        EXPECT_NEAR(_expected.poses[i].pose.position.z, _path.poses[i].pose.position.z, _tolerance);
+    }
+}
+
+TEST(PathCodecTestSuite, smoothPathCompressesWithinResolution) {
+    nav_msgs::Path path = helix(10000);
+    std::vector<uint8_t> data = upat_follower::encodePath(path, 0.001);
+    EXPECT_LT(data.size() * 10, path.poses.size() * 3 * sizeof(double));
+    nav_msgs::Path decoded;
+    ASSERT_TRUE(upat_follower::decodePath(data.data(), data.size(), decoded));
+    expectNear(path, decoded, 0.0005 + 1e-9);
+}
+
+TEST(PathCodecTestSuite, randomPathKeepsLargeJumps) {
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> position(-1e6, 1e6);
+    nav_msgs::Path path;
+    path.poses.resize(1000);
+    for (auto &pose : path.poses) {
+        pose.pose.position.x = position(generator);
+        pose.pose.position.y = position(generator);
+        pose.pose.position.z = position(generator);
+    }
+    path.poses[500].pose.position.x = 1e12;
+    path.poses[501].pose.position.x = -1e12;
+    std::vector<uint8_t> data = upat_follower::encodePath(path, 0.001);
+    nav_msgs::Path decoded;
+    ASSERT_TRUE(upat_follower::decodePath(data.data(), data.size(), decoded));
+    expectNear(path, decoded, 0.0005 * (1 + 1e-6));
+}
+
+TEST(PathCodecTestSuite, shortPaths) {
+    for (int points = 0; points < 4; points++) {
+        nav_msgs::Path path = helix(points);
+        upat_follower::CompressedPath compressed_path = upat_follower::toCompressedPath(path, 0.01);
+        EXPECT_EQ(compressed_path.size, points);
+        EXPECT_EQ(compressed_path.header.frame_id, "map");
+        nav_msgs::Path decoded = upat_follower::toPath(compressed_path);
+        EXPECT_EQ(decoded.header.frame_id, "map");
+        expectNear(path, decoded, 0.005 + 1e-9);
+    }
+}
+
+TEST(PathCodecTestSuite, truncatedDataIsRejected) {
+    nav_msgs::Path path = helix(1000);
+    std::vector<uint8_t> data = upat_follower::encodePath(path);
+    nav_msgs::Path decoded;
+    for (size_t size : {size_t(0), size_t(10), data.size() / 2, data.size() - 1}) {
+        EXPECT_FALSE(upat_follower::decodePath(data.data(), size, decoded));
+    }
+    data[0] = 'X';
+    EXPECT_FALSE(upat_follower::decodePath(data.data(), data.size(), decoded));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
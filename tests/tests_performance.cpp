@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+#include <ros/package.h>
+#include <ros/ros.h>
+#include <unistd.h>
+#include <upat_follower/follower.h>
+#include <upat_follower/generator.h>
+#include <upat_follower/mission_io.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+// Median time and peak heap of every case are compared with the baselines of this machine, tests/perf_baselines/
+// <hostname>.csv or the file named by UPAT_PERF_BASELINES. Without them times are not compared, other machines may be
+// slower, and the peak heap is compared with the committed reference.csv. The time of every long case over its short
+// one does not depend on the machine, and it is always compared with the baselines to catch costs that grow faster
+// than the mission. A case without baseline fails. UPAT_PERF_UPDATE_BASELINES=1 records the baselines of this machine,
+// the only time the file is written. UPAT_PERF_TIME_TOLERANCE, UPAT_PERF_MEMORY_TOLERANCE and
+// UPAT_PERF_SCALING_TOLERANCE relax the allowed growth (default 0.5, 0.25 and 2.0).
+
+namespace {
+
+// Heap in use and its peak, tracked by the operator new below
+std::atomic<int64_t> heap_in_use(0), heap_peak(0);
+
+void resetHeapPeak() {
+    heap_peak = heap_in_use.load();
+}
+
+struct PerfSample {
+    double median_ms;
+    double peak_kb;
+};
+
+std::map<std::string, PerfSample> baselines, reference_baselines, samples;
+std::string baselines_file, reference_file;
+
+double envDouble(const char *_name, double _default) {
+    const char *value = std::getenv(_name);
+    return value ? std::atof(value) : _default;
+}
+
+bool updateBaselines() {
+    const char *value = std::getenv("UPAT_PERF_UPDATE_BASELINES");
+    return value && std::string(value) == "1";
+}
+
+// Baselines of this machine, recorded there when updating. Empty if it has none
+std::string baselinesFile() {
+    const char *file_name = std::getenv("UPAT_PERF_BASELINES");
+    if (file_name && *file_name) return file_name;
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    std::string host_file = ros::package::getPath("upat_follower") + "/tests/perf_baselines/" + host + ".csv";
+    if (updateBaselines() || std::ifstream(host_file).good()) return host_file;
+    return "";
+}
+
+void readBaselines(const std::string &_file_name, std::map<std::string, PerfSample> &_baselines) {
+    std::ifstream file(_file_name);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::stringstream fields(line);
+        std::string name;
+        PerfSample sample;
+        if (fields >> name >> sample.median_ms >> sample.peak_kb) _baselines[name] = sample;
+    }
+}
+
+void loadBaselines() {
+    reference_file = ros::package::getPath("upat_follower") + "/tests/perf_baselines/reference.csv";
+    readBaselines(reference_file, reference_baselines);
+    baselines_file = baselinesFile();
+    if (!baselines_file.empty()) readBaselines(baselines_file, baselines);
+    if (baselines_file.empty()) std::cout << "Times not compared, this machine has no baselines (tests/perf_baselines/<hostname>.csv or UPAT_PERF_BASELINES)" << std::endl;
+}
+
+void saveBaselines() {
+    if (!updateBaselines()) return;
+    for (auto &sample : samples) baselines[sample.first] = sample.second;
+    std::ofstream file(baselines_file);
+    file << "# case, median ms, peak heap kB" << std::endl;
+    for (auto &baseline : baselines) file << baseline.first << ", " << baseline.second.median_ms << ", " << baseline.second.peak_kb << std::endl;
+    std::cout << "Baselines recorded in " << baselines_file << std::endl;
+}
+
+// Median time and peak heap of _runs runs of _run, compared with the baseline of _name
+template <typename F>
+void expectNoRegression(const std::string &_name, int _runs, F _run) {
+    std::vector<double> times;
+    int64_t peak = 0;
+    for (int i = 0; i < _runs; i++) {
+        int64_t heap_before = heap_in_use.load();
+        resetHeapPeak();
+        auto begin = std::chrono::steady_clock::now();
+        _run();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+        peak = std::max(peak, heap_peak.load() - heap_before);
+    }
+    std::sort(times.begin(), times.end());
+    PerfSample sample = {times[times.size() / 2], peak / 1024.0};
+    samples[_name] = sample;
+    std::cout << _name << ": " << sample.median_ms << " ms, " << sample.peak_kb << " kB" << std::endl;
+    if (updateBaselines()) return;
+    if (!baselines_file.empty() && !baselines.count(_name)) {
+        ADD_FAILURE() << "No baseline for " << _name << " in " << baselines_file << ", record it with UPAT_PERF_UPDATE_BASELINES=1";
+        return;
+    }
+    if (baselines_file.empty() && !reference_baselines.count(_name)) {
+        ADD_FAILURE() << "No baseline for " << _name << " in " << reference_file;
+        return;
+    }
+    // Small absolute margins keep cases of a few milliseconds or kilobytes from failing on noise
+    const PerfSample &baseline = baselines_file.empty() ? reference_baselines[_name] : baselines[_name];
+    EXPECT_LE(sample.peak_kb, baseline.peak_kb * (1 + envDouble("UPAT_PERF_MEMORY_TOLERANCE", 0.25)) + 64.0) << _name << " memory regression";
+    if (baselines_file.empty()) return;
+    EXPECT_LE(sample.median_ms, baseline.median_ms * (1 + envDouble("UPAT_PERF_TIME_TOLERANCE", 0.5)) + 1.0) << _name << " time regression";
+}
+
+// Time of _long_name over the time of _short_name, compared with the same ratio of the baselines
+void expectSameScaling(const std::string &_short_name, const std::string &_long_name) {
+    if (updateBaselines() || !samples.count(_short_name) || !samples.count(_long_name)) return;
+    const std::map<std::string, PerfSample> &scaling_baselines = baselines_file.empty() ? reference_baselines : baselines;
+    if (!scaling_baselines.count(_short_name) || !scaling_baselines.count(_long_name)) return;  // Already failed
+    double ratio = samples[_long_name].median_ms / samples[_short_name].median_ms;
+    double baseline_ratio = scaling_baselines.at(_long_name).median_ms / scaling_baselines.at(_short_name).median_ms;
+    std::cout << _long_name << " / " << _short_name << ": " << ratio << " (baseline " << baseline_ratio << ")" << std::endl;
+    EXPECT_LE(ratio, baseline_ratio * (1 + envDouble("UPAT_PERF_SCALING_TOLERANCE", 2.0))) << _long_name << " grows faster than " << _short_name;
+}
+
+nav_msgs::Path testMission() {
+    return upat_follower::csvToPath(ros::package::getPath("upat_follower") + "/tests/splines/init.csv");
+}
+
+// Staircase of _count waypoints with legs of _spacing meters, long enough to expose quadratic costs
+nav_msgs::Path longMission(int _count, double _spacing) {
+    nav_msgs::Path path;
+    path.poses.resize(_count);
+    for (int i = 0; i < _count; i++) {
+        path.poses[i].pose.position.x = ((i + 1) / 2) * _spacing;
+        path.poses[i].pose.position.y = (i / 2) * _spacing;
+        path.poses[i].pose.position.z = 5.0 + 0.01 * i;
+        path.poses[i].pose.orientation.w = 1;
+    }
+    return path;
+}
+
+// Closed loop at 30 Hz, the UAV moves with the commanded velocity until the end of the path
+int flyPath(const nav_msgs::Path &_path, int _max_ticks) {
+    upat_follower::Follower follower(1);
+    follower.loadPath(_path, 1.2, 1.0);
+    geometry_msgs::PoseStamped pose = _path.poses.front();
+    const geometry_msgs::Point &end = _path.poses.back().pose.position;
+    double tick_period = 1.0 / 30.0;
+    int ticks = 0;
+    for (; ticks < _max_ticks; ticks++) {
+        pose.header.stamp = ros::Time(1.0 + ticks * tick_period);
+        follower.updatePose(pose);
+        geometry_msgs::TwistStamped velocity = follower.getVelocity();
+        pose.pose.position.x += velocity.twist.linear.x * tick_period;
+        pose.pose.position.y += velocity.twist.linear.y * tick_period;
+        pose.pose.position.z += velocity.twist.linear.z * tick_period;
+        double dx = pose.pose.position.x - end.x, dy = pose.pose.position.y - end.y, dz = pose.pose.position.z - end.z;
+        if (dx * dx + dy * dy + dz * dz < 0.25) break;
+    }
+    return ticks;
+}
+
+}  // namespace
+
+void *operator new(std::size_t _size) {
+    // The size is kept before the block to account for it on delete
+    std::size_t *block = static_cast<std::size_t *>(std::malloc(_size + sizeof(std::max_align_t)));
+    if (!block) throw std::bad_alloc();
+    *block = _size;
+    int64_t in_use = heap_in_use += _size;
+    int64_t peak = heap_peak.load();
+    while (in_use > peak && !heap_peak.compare_exchange_weak(peak, in_use)) {
+    }
+    return reinterpret_cast<char *>(block) + sizeof(std::max_align_t);
+}
+
+void operator delete(void *_pointer) noexcept {
+    if (!_pointer) return;
+    std::size_t *block = reinterpret_cast<std::size_t *>(static_cast<char *>(_pointer) - sizeof(std::max_align_t));
+    heap_in_use -= *block;
+    std::free(block);
+}
+
+void *operator new[](std::size_t _size) {
+    return operator new(_size);
+}
+
+void operator delete[](void *_pointer) noexcept {
+    operator delete(_pointer);
+}
+
+void operator delete(void *_pointer, std::size_t) noexcept {
+    operator delete(_pointer);
+}
+
+void operator delete[](void *_pointer, std::size_t) noexcept {
+    operator delete(_pointer);
+}
+
+TEST(PerformanceTestSuite, generatePath) {
+    nav_msgs::Path init_path = testMission();
+    nav_msgs::Path long_path = longMission(200, 2.0);
+    const char *modes[] = {"interp1", "cubic_spline_loyal", "cubic_spline"};
+    for (int mode = 0; mode < 3; mode++) {
+        upat_follower::Generator generator(2.0, 3.0, 1.0);
+        expectNoRegression(std::string("generate_path_") + modes[mode], 7, [&] { generator.generatePath(init_path, mode); });
+        expectNoRegression(std::string("generate_path_long_") + modes[mode], 3, [&] { generator.generatePath(long_path, mode); });
+        expectSameScaling(std::string("generate_path_") + modes[mode], std::string("generate_path_long_") + modes[mode]);
+    }
+}
+
+TEST(PerformanceTestSuite, followerLoop) {
+    upat_follower::Generator generator(2.0, 3.0, 1.0);
+    nav_msgs::Path path = generator.generatePath(testMission(), 2);
+    nav_msgs::Path long_path = generator.generatePath(longMission(200, 2.0), 0);
+    int ticks = 0, long_ticks = 0;
+    expectNoRegression("follower_loop", 7, [&] { ticks = flyPath(path, 20000); });
+    expectNoRegression("follower_loop_long", 3, [&] { long_ticks = flyPath(long_path, 40000); });
+    expectSameScaling("follower_loop", "follower_loop_long");
+    // Tick counts tell a slower follower apart from a longer flight
+    EXPECT_GT(ticks, 0);
+    EXPECT_GT(long_ticks, 0);
+    std::cout << "follower_loop: " << ticks << " ticks, follower_loop_long: " << long_ticks << " ticks" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    ros::init(argc, argv, "tests_performance", ros::init_options::AnonymousName | ros::init_options::NoRosout | ros::init_options::NoSigintHandler);
+    ros::Time::init();
+    testing::InitGoogleTest(&argc, argv);
+    loadBaselines();
+
+    auto res = RUN_ALL_TESTS();
+
+    saveBaselines();
+
+    return res;
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <upat_follower/ring_buffer.h>
+#include <vector>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+
+TEST(RingBufferTestSuite, keepsNewest) {
+    upat_follower::RingBuffer<int> buffer(4);
+    EXPECT_TRUE(buffer.empty());
+    for (int i = 0; i < 10; i++) EXPECT_TRUE(buffer.push(i));
+    ASSERT_EQ(buffer.size(), 4);
+    EXPECT_EQ(buffer.capacity(), 4);
+    for (int i = 0; i < 4; i++) EXPECT_EQ(buffer[i], 6 + i);
+    EXPECT_EQ(buffer.back(), 9);
+    EXPECT_EQ(buffer.firstSeq(), 6);
+    EXPECT_EQ(buffer.nextSeq(), 10);
+}
+
+TEST(RingBufferTestSuite, copySince) {
+    upat_follower::RingBuffer<int> buffer(4);
+    std::vector<int> out;
+    EXPECT_EQ(buffer.copySince(0, out), 0);
+    EXPECT_TRUE(out.empty());
+    for (int i = 0; i < 3; i++) buffer.push(i);
+    EXPECT_EQ(buffer.copySince(1, out), 1);
+    EXPECT_EQ(out, std::vector<int>({1, 2}));
+    // Nothing new after the last sequence number
+    out.clear();
+    EXPECT_EQ(buffer.copySince(buffer.nextSeq(), out), 3);
+    EXPECT_TRUE(out.empty());
+    // Items already overwritten are skipped, the returned sequence number tells where the copy starts
+    for (int i = 3; i < 9; i++) buffer.push(i);
+    out.clear();
+    EXPECT_EQ(buffer.copySince(2, out), 5);
+    EXPECT_EQ(out, std::vector<int>({5, 6, 7, 8}));
+    // Appended to what is already there
+    EXPECT_EQ(buffer.copySince(7, out), 7);
+    EXPECT_EQ(out, std::vector<int>({5, 6, 7, 8, 7, 8}));
+}
+
+TEST(RingBufferTestSuite, decimation) {
+    upat_follower::RingBuffer<int> buffer(10, 3);
+    int stored = 0;
+    for (int i = 0; i < 10; i++) stored += buffer.push(i);
+    EXPECT_EQ(stored, 4);
+    std::vector<int> out;
+    EXPECT_EQ(buffer.copySince(0, out), 0);
+    EXPECT_EQ(out, std::vector<int>({0, 3, 6, 9}));
+    EXPECT_EQ(buffer.nextSeq(), 4);
+}
+
+TEST(RingBufferTestSuite, clear) {
+    upat_follower::RingBuffer<int> buffer(4);
+    for (int i = 0; i < 6; i++) buffer.push(i);
+    buffer.clear();
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(buffer.nextSeq(), 0);
+    buffer.push(42);
+    std::vector<int> out;
+    EXPECT_EQ(buffer.copySince(0, out), 0);
+    EXPECT_EQ(out, std::vector<int>({42}));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
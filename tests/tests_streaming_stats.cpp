@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <upat_follower/streaming_stats.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+
+double exactQuantile(std::vector<double> _values, double _p) {
+    std::sort(_values.begin(), _values.end());
+    return _values[std::min(_values.size() - 1, (size_t)std::ceil(_p * _values.size()) - 1)];
+}
+
+TEST(StreamingStatsTestSuite, fewSamplesAreExact) {
+    upat_follower::StreamingStats stats;
+    stats.add(3.0);
+    stats.add(1.0);
+    stats.add(2.0);
+    upat_follower::ErrorStats msg = stats.toMsg();
+    EXPECT_EQ(3, msg.count);
+    EXPECT_DOUBLE_EQ(2.0, msg.mean);
+    EXPECT_DOUBLE_EQ(std::sqrt(14.0 / 3.0), msg.rms);
+    EXPECT_DOUBLE_EQ(3.0, msg.max);
+    EXPECT_DOUBLE_EQ(2.0, msg.p50);
+    EXPECT_DOUBLE_EQ(3.0, msg.p99);
+}
+
+TEST(StreamingStatsTestSuite, quantilesCloseToExact) {
+    // Tracking errors are positive and skewed, as a half normal distribution
+    std::mt19937 generator(7);
+    std::normal_distribution<double> distribution(0.0, 0.3);
+    upat_follower::StreamingStats stats;
+    std::vector<double> values;
+    for (int i = 0; i < 100000; i++) {
+        double distance = std::fabs(distribution(generator));
+        values.push_back(distance);
+        stats.add(distance);
+    }
+    upat_follower::ErrorStats msg = stats.toMsg();
+    EXPECT_NEAR(exactQuantile(values, 0.5), msg.p50, 0.01);
+    EXPECT_NEAR(exactQuantile(values, 0.95), msg.p95, 0.01);
+    EXPECT_NEAR(exactQuantile(values, 0.99), msg.p99, 0.02);
+    EXPECT_DOUBLE_EQ(*std::max_element(values.begin(), values.end()), msg.max);
+}
+
+TEST(StreamingStatsTestSuite, reset) {
+    upat_follower::StreamingStats stats;
+    for (int i = 0; i < 10; i++) stats.add(i);
+    stats.reset();
+    stats.add(0.5);
+    EXPECT_EQ(1, stats.count());
+    EXPECT_DOUBLE_EQ(0.5, stats.toMsg().p95);
+    EXPECT_DOUBLE_EQ(0.5, stats.max());
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
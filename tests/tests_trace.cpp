@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <upat_follower/trace.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// terminal: catkin build --verbose --catkin-make-args run_tests | sed -n '/\[==========\]/,/\[==========\]/p'
+
+std::string readFile(const std::string &_file_name) {
+    std::ifstream file(_file_name);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+int countOf(const std::string &_text, const std::string &_pattern) {
+    int count = 0;
+    for (size_t pos = _text.find(_pattern); pos != std::string::npos; pos = _text.find(_pattern, pos + 1)) count++;
+    return count;
+}
+
+TEST(TraceTestSuite, disabledRecordsNothing) {
+    std::string file_name = "/tmp/upat_follower_tests_trace_disabled.json";
+    {
+        UPAT_TRACE_SCOPE("disabled");
+    }
+    ASSERT_TRUE(upat_follower::dumpTrace(file_name));
+    EXPECT_EQ(countOf(readFile(file_name), "\"disabled\""), 0);
+    std::remove(file_name.c_str());
+}
+
+TEST(TraceTestSuite, spansOfEveryThreadAreDumped) {
+    std::string file_name = "/tmp/upat_follower_tests_trace.json";
+    upat_follower::enableTracing(file_name, 8);
+    std::thread worker([] {
+        for (int i = 0; i < 3; i++) {
+            UPAT_TRACE_SCOPE("worker");
+        }
+    });
+    worker.join();
+    for (int i = 0; i < 20; i++) {
+        UPAT_TRACE_SCOPE("main");
+    }
+    upat_follower::disableTracing();
+    {
+        UPAT_TRACE_SCOPE("after");
+    }
+    ASSERT_TRUE(upat_follower::dumpTrace(file_name));
+    std::string trace = readFile(file_name);
+    EXPECT_EQ(trace.find("{\"traceEvents\":["), 0);
+    EXPECT_EQ(countOf(trace, "\"name\":\"worker\""), 3);
+    // Rings keep the last 8 spans of their thread
+    EXPECT_EQ(countOf(trace, "\"name\":\"main\""), 8);
+    EXPECT_EQ(countOf(trace, "\"name\":\"after\""), 0);
+    EXPECT_EQ(countOf(trace, "\"ph\":\"X\""), 11);
+    // Nothing is left behind when the test exits
+    upat_follower::cancelExitTrace();
+    std::remove(file_name.c_str());
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}